@@ -31,6 +31,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 _X_EXPORT CallbackListPtr XaceHooks[XACE_NUM_HOOKS] = { 0 };
 
+/* xace.h wraps these in inline checks of XaceHooks; the functions below
+ * are what the checks call once a hook has callbacks.
+ */
+#undef XaceHook
+#undef XaceHookDispatch
+#undef XaceHookPropertyAccess
+#undef XaceHookSelectionAccess
+#undef XaceHookAuditEnd
+
 /* Special-cased hook functions.  Called by Xserver.
  */
 int
@@ -78,6 +78,25 @@ extern _X_EXPORT int XaceHookSelectionAccess(ClientPtr ptr, Selection ** ppSel,
                                              Mask access_mode);
 extern _X_EXPORT void XaceHookAuditEnd(ClientPtr ptr, int result);
 
+/* Skip the hook functions inline while a hook has never had a callback.
+ * Arguments are not evaluated then, so they must not have side effects.
+ */
+#define XaceHook(hook, ...) \
+    (XaceHooks[hook] ? XaceHook(hook, __VA_ARGS__) : Success)
+#define XaceHookDispatch(ptr, major) \
+    ((XaceHooks[XACE_AUDIT_BEGIN] || XaceHooks[XACE_CORE_DISPATCH] || \
+      XaceHooks[XACE_EXT_DISPATCH]) ? \
+     XaceHookDispatch(ptr, major) : Success)
+#define XaceHookPropertyAccess(ptr, pWin, ppProp, access_mode) \
+    (XaceHooks[XACE_PROPERTY_ACCESS] ? \
+     XaceHookPropertyAccess(ptr, pWin, ppProp, access_mode) : Success)
+#define XaceHookSelectionAccess(ptr, ppSel, access_mode) \
+    (XaceHooks[XACE_SELECTION_ACCESS] ? \
+     XaceHookSelectionAccess(ptr, ppSel, access_mode) : Success)
+#define XaceHookAuditEnd(ptr, result) \
+    (XaceHooks[XACE_AUDIT_END] ? \
+     XaceHookAuditEnd(ptr, result) : (void) 0)
+
 /* Register a callback for a given hook.
  */
 #define XaceRegisterCallback(hook,callback,data) \
@@ -29,6 +29,9 @@
 #include <string.h>
 #include "hashtable.h"
 #include "picturestr.h"
+#include "reqstats.h"
+#include "xresstats.h"
+#include "xace.h"
 
 #ifdef COMPOSITE
 #include "compint.h"
@@ -1076,6 +1079,319 @@ ProcXResQueryResourceBytes (ClientPtr client)
     return rc;
 }
 
+static void
+CountRequestStats(int major, int minor, ReqStatsPtr stats, void *closure)
+{
+    (*(int *) closure)++;
+}
+
+static void
+FillRequestStats(int major, int minor, ReqStatsPtr stats, void *closure)
+{
+    xXResRequestStats **out = closure;
+
+    **out = (xXResRequestStats) {
+        .major = major,
+        .minor = minor,
+        .max_time = stats->max_time,
+        .count = stats->count,
+        .time = stats->time,
+        .bytes_in = stats->bytes_in,
+        .bytes_out = stats->bytes_out
+    };
+    (*out)++;
+}
+
+/** @brief Checks the reset flag of the request stats requests.  Clearing
+           the server-wide counters needs DixManageAccess to the server. */
+static int
+CheckRequestStatsReset(ClientPtr client, BOOL reset)
+{
+    if (reset != xFalse && reset != xTrue) {
+        client->errorValue = reset;
+        return BadValue;
+    }
+    if (!reset)
+        return Success;
+    return XaceHook(XACE_SERVER_ACCESS, client, DixManageAccess);
+}
+
+/** @brief Reports the request counters of every opcode seen since the
+           last reset, optionally resetting all counters afterwards. */
+static int
+ProcXResQueryRequestStats(ClientPtr client)
+{
+    REQUEST(xXResQueryRequestStatsReq);
+    xXResQueryRequestStatsReply rep;
+    xXResRequestStats *stats, *cur;
+    int i, rc, num_stats = 0;
+
+    REQUEST_SIZE_MATCH(xXResQueryRequestStatsReq);
+
+    rc = CheckRequestStatsReset(client, stuff->reset);
+    if (rc != Success)
+        return rc;
+
+    ReqStatsForEach(CountRequestStats, &num_stats);
+
+    stats = xallocarray(num_stats, sizeof(xXResRequestStats));
+    if (num_stats && !stats)
+        return BadAlloc;
+
+    cur = stats;
+    ReqStatsForEach(FillRequestStats, &cur);
+
+    if (stuff->reset)
+        ReqStatsReset();
+
+    rep = (xXResQueryRequestStatsReply) {
+        .type = X_Reply,
+        .sequenceNumber = client->sequence,
+        .length = bytes_to_int32(num_stats * sz_xXResRequestStats),
+        .numStats = num_stats
+    };
+    if (client->swapped) {
+        swaps(&rep.sequenceNumber);
+        swapl(&rep.length);
+        swapl(&rep.numStats);
+
+        for (i = 0; i < num_stats; i++) {
+            swapl(&stats[i].max_time);
+            swapll(&stats[i].count);
+            swapll(&stats[i].time);
+            swapll(&stats[i].bytes_in);
+            swapll(&stats[i].bytes_out);
+        }
+    }
+    WriteToClient(client, sizeof(xXResQueryRequestStatsReply), &rep);
+    WriteToClient(client, num_stats * sz_xXResRequestStats, stats);
+
+    free(stats);
+
+    return Success;
+}
+
+static int
+CompareClientRequestTime(const void *a, const void *b)
+{
+    const xXResClientRequestStats *sa = a, *sb = b;
+
+    if (sa->time != sb->time)
+        return sa->time > sb->time ? -1 : 1;
+    return sa->count > sb->count ? -1 : sa->count < sb->count;
+}
+
+/** @brief Reports per-client request counters, busiest client first,
+           optionally resetting all counters afterwards. */
+static int
+ProcXResQueryClientRequestStats(ClientPtr client)
+{
+    REQUEST(xXResQueryClientRequestStatsReq);
+    xXResQueryClientRequestStatsReply rep;
+    xXResClientRequestStats *stats;
+    int i, rc, num_clients = 0;
+
+    REQUEST_SIZE_MATCH(xXResQueryClientRequestStatsReq);
+
+    rc = CheckRequestStatsReset(client, stuff->reset);
+    if (rc != Success)
+        return rc;
+
+    stats = xallocarray(currentMaxClients, sizeof(xXResClientRequestStats));
+    if (!stats)
+        return BadAlloc;
+
+    for (i = 0; i < currentMaxClients; i++) {
+        ReqStatsPtr cs;
+
+        if (!clients[i])
+            continue;
+
+        cs = &clients[i]->reqStats;
+        stats[num_clients++] = (xXResClientRequestStats) {
+            .resource_base = clients[i]->clientAsMask,
+            .max_time = cs->max_time,
+            .count = cs->count,
+            .time = cs->time,
+            .bytes_in = cs->bytes_in,
+            .bytes_out = cs->bytes_out
+        };
+    }
+
+    qsort(stats, num_clients, sizeof(xXResClientRequestStats),
+          CompareClientRequestTime);
+
+    if (stuff->reset)
+        ReqStatsReset();
+
+    rep = (xXResQueryClientRequestStatsReply) {
+        .type = X_Reply,
+        .sequenceNumber = client->sequence,
+        .length = bytes_to_int32(num_clients * sz_xXResClientRequestStats),
+        .numStats = num_clients
+    };
+    if (client->swapped) {
+        swaps(&rep.sequenceNumber);
+        swapl(&rep.length);
+        swapl(&rep.numStats);
+
+        for (i = 0; i < num_clients; i++) {
+            swapl(&stats[i].resource_base);
+            swapl(&stats[i].max_time);
+            swapll(&stats[i].count);
+            swapll(&stats[i].time);
+            swapll(&stats[i].bytes_in);
+            swapll(&stats[i].bytes_out);
+        }
+    }
+    WriteToClient(client, sizeof(xXResQueryClientRequestStatsReply), &rep);
+    WriteToClient(client, num_clients * sz_xXResClientRequestStats, stats);
+
+    free(stats);
+
+    return Success;
+}
+
+static int
+CompareClientBufferSize(const void *a, const void *b)
+{
+    const xXResClientBufferStats *sa = a, *sb = b;
+    CARD32 size_a = sa->input + sa->output, size_b = sb->input + sb->output;
+
+    if (size_a != size_b)
+        return size_a > size_b ? -1 : 1;
+    return sa->peak > sb->peak ? -1 : sa->peak < sb->peak;
+}
+
+/** @brief Reports the I/O buffer memory held by each client, largest
+           first, along with the memory kept by the shared buffer pool. */
+static int
+ProcXResQueryClientBufferStats(ClientPtr client)
+{
+    xXResQueryClientBufferStatsReply rep;
+    xXResClientBufferStats *stats;
+    unsigned int pool_buffers, pool_bytes;
+    int i, num_clients = 0;
+
+    REQUEST_SIZE_MATCH(xXResQueryClientBufferStatsReq);
+
+    stats = xallocarray(currentMaxClients, sizeof(xXResClientBufferStats));
+    if (!stats)
+        return BadAlloc;
+
+    for (i = 0; i < currentMaxClients; i++) {
+        ClientBufferStatsRec cs;
+
+        if (!clients[i] || clients[i] == serverClient)
+            continue;
+
+        GetClientBufferStats(clients[i], &cs);
+        stats[num_clients++] = (xXResClientBufferStats) {
+            .resource_base = clients[i]->clientAsMask,
+            .input = cs.input,
+            .output = cs.output,
+            .peak = cs.peak,
+            .allocs = cs.allocs
+        };
+    }
+
+    qsort(stats, num_clients, sizeof(xXResClientBufferStats),
+          CompareClientBufferSize);
+
+    GetBufferPoolStats(&pool_buffers, &pool_bytes);
+
+    rep = (xXResQueryClientBufferStatsReply) {
+        .type = X_Reply,
+        .sequenceNumber = client->sequence,
+        .length = bytes_to_int32(num_clients * sz_xXResClientBufferStats),
+        .numStats = num_clients,
+        .poolBuffers = pool_buffers,
+        .poolBytes = pool_bytes
+    };
+    if (client->swapped) {
+        swaps(&rep.sequenceNumber);
+        swapl(&rep.length);
+        swapl(&rep.numStats);
+        swapl(&rep.poolBuffers);
+        swapl(&rep.poolBytes);
+
+        for (i = 0; i < num_clients; i++) {
+            swapl(&stats[i].resource_base);
+            swapl(&stats[i].input);
+            swapl(&stats[i].output);
+            swapl(&stats[i].peak);
+            swapl(&stats[i].allocs);
+        }
+    }
+    WriteToClient(client, sizeof(xXResQueryClientBufferStatsReply), &rep);
+    WriteToClient(client, num_clients * sz_xXResClientBufferStats, stats);
+
+    free(stats);
+
+    return Success;
+}
+
+/** @brief Reports the object caches of every screen. */
+static int
+ProcXResQueryObjectCacheStats(ClientPtr client)
+{
+    xXResQueryObjectCacheStatsReply rep;
+    xXResObjectCacheStats *stats;
+    DevPrivateType type;
+    int i, num_stats = 0;
+
+    REQUEST_SIZE_MATCH(xXResQueryObjectCacheStatsReq);
+
+    stats = xallocarray(screenInfo.numScreens * PRIVATE_LAST,
+                        sizeof(xXResObjectCacheStats));
+    if (!stats)
+        return BadAlloc;
+
+    for (i = 0; i < screenInfo.numScreens; i++) {
+        for (type = PRIVATE_XSELINUX; type < PRIVATE_LAST; type++) {
+            ObjectCacheStatsRec cs;
+
+            if (!dixGetObjectCacheStats(screenInfo.screens[i], type, &cs))
+                continue;
+            stats[num_stats++] = (xXResObjectCacheStats) {
+                .screen = i,
+                .type = MakeAtom(cs.name, strlen(cs.name), TRUE),
+                .size = cs.size,
+                .cached = cs.cached,
+                .allocs = cs.allocs,
+                .reused = cs.reused
+            };
+        }
+    }
+
+    rep = (xXResQueryObjectCacheStatsReply) {
+        .type = X_Reply,
+        .sequenceNumber = client->sequence,
+        .length = bytes_to_int32(num_stats * sz_xXResObjectCacheStats),
+        .numStats = num_stats
+    };
+    if (client->swapped) {
+        swaps(&rep.sequenceNumber);
+        swapl(&rep.length);
+        swapl(&rep.numStats);
+
+        for (i = 0; i < num_stats; i++) {
+            swapl(&stats[i].screen);
+            swapl(&stats[i].type);
+            swapl(&stats[i].size);
+            swapl(&stats[i].cached);
+            swapll(&stats[i].allocs);
+            swapll(&stats[i].reused);
+        }
+    }
+    WriteToClient(client, sizeof(xXResQueryObjectCacheStatsReply), &rep);
+    WriteToClient(client, num_stats * sz_xXResObjectCacheStats, stats);
+
+    free(stats);
+
+    return Success;
+}
+
 static int
 ProcResDispatch(ClientPtr client)
 {
@@ -1093,6 +1409,14 @@ ProcResDispatch(ClientPtr client)
         return ProcXResQueryClientIds(client);
     case X_XResQueryResourceBytes:
         return ProcXResQueryResourceBytes(client);
+    case X_XResQueryRequestStats:
+        return ProcXResQueryRequestStats(client);
+    case X_XResQueryClientRequestStats:
+        return ProcXResQueryClientRequestStats(client);
+    case X_XResQueryClientBufferStats:
+        return ProcXResQueryClientBufferStats(client);
+    case X_XResQueryObjectCacheStats:
+        return ProcXResQueryObjectCacheStats(client);
     default: break;
     }
 
@@ -1175,6 +1499,14 @@ SProcResDispatch (ClientPtr client)
         return SProcXResQueryClientIds(client);
     case X_XResQueryResourceBytes:
         return SProcXResQueryResourceBytes(client);
+    case X_XResQueryRequestStats:      /* nothing to swap */
+        return ProcXResQueryRequestStats(client);
+    case X_XResQueryClientRequestStats:        /* nothing to swap */
+        return ProcXResQueryClientRequestStats(client);
+    case X_XResQueryClientBufferStats: /* nothing to swap */
+        return ProcXResQueryClientBufferStats(client);
+    case X_XResQueryObjectCacheStats:  /* nothing to swap */
+        return ProcXResQueryObjectCacheStats(client);
     default: break;
     }
 
@@ -0,0 +1,145 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifndef XRESSTATS_H
+#define XRESSTATS_H
+
+#include <X11/Xmd.h>
+
+/*
+ * Server statistics, added in version 1.3 of the X-Resource extension as
+ * implemented by this server.  These requests are not part of XResProto.
+ *
+ * QueryRequestStats and QueryClientRequestStats report the counters
+ * collected by Dispatch(), see reqstats.h.  Setting reset clears the
+ * counters of every client and opcode once the reply is built, which
+ * needs DixManageAccess to the server; values other than xFalse and
+ * xTrue are a BadValue error.
+ */
+
+#define X_XResQueryRequestStats         6
+#define X_XResQueryClientRequestStats   7
+#define X_XResQueryClientBufferStats    8
+#define X_XResQueryObjectCacheStats     9
+
+typedef struct _XResQueryRequestStats {
+    CARD8   reqType;
+    CARD8   XResReqType;
+    CARD16  length;
+    BOOL    reset;
+    CARD8   pad1;
+    CARD16  pad2;
+} xXResQueryRequestStatsReq;
+#define sz_xXResQueryRequestStatsReq 8
+
+typedef xXResQueryRequestStatsReq xXResQueryClientRequestStatsReq;
+#define sz_xXResQueryClientRequestStatsReq 8
+
+typedef struct {
+    CARD8   type;
+    CARD8   pad1;
+    CARD16  sequenceNumber;
+    CARD32  length;
+    CARD32  numStats;
+    CARD32  pad2;
+    CARD32  pad3;
+    CARD32  pad4;
+    CARD32  pad5;
+    CARD32  pad6;
+} xXResQueryRequestStatsReply;
+#define sz_xXResQueryRequestStatsReply 32
+
+typedef xXResQueryRequestStatsReply xXResQueryClientRequestStatsReply;
+#define sz_xXResQueryClientRequestStatsReply 32
+
+typedef struct {
+    CARD8   major;
+    CARD8   minor;
+    CARD16  pad;
+    CARD32  max_time;
+    CARD64  count;
+    CARD64  time;
+    CARD64  bytes_in;
+    CARD64  bytes_out;
+} xXResRequestStats;
+#define sz_xXResRequestStats 40
+
+typedef struct {
+    CARD32  resource_base;
+    CARD32  max_time;
+    CARD64  count;
+    CARD64  time;
+    CARD64  bytes_in;
+    CARD64  bytes_out;
+} xXResClientRequestStats;
+#define sz_xXResClientRequestStats 40
+
+typedef struct {
+    CARD8   reqType;
+    CARD8   XResReqType;
+    CARD16  length;
+} xXResQueryClientBufferStatsReq;
+#define sz_xXResQueryClientBufferStatsReq 4
+
+typedef struct {
+    CARD8   type;
+    CARD8   pad1;
+    CARD16  sequenceNumber;
+    CARD32  length;
+    CARD32  numStats;
+    CARD32  poolBuffers;        /* free buffers held by the pool */
+    CARD32  poolBytes;
+    CARD32  pad2;
+    CARD32  pad3;
+    CARD32  pad4;
+} xXResQueryClientBufferStatsReply;
+#define sz_xXResQueryClientBufferStatsReply 32
+
+typedef struct {
+    CARD32  resource_base;
+    CARD32  input;
+    CARD32  output;
+    CARD32  peak;
+    CARD32  allocs;
+} xXResClientBufferStats;
+#define sz_xXResClientBufferStats 20
+
+typedef xXResQueryClientBufferStatsReq xXResQueryObjectCacheStatsReq;
+#define sz_xXResQueryObjectCacheStatsReq 4
+
+typedef xXResQueryRequestStatsReply xXResQueryObjectCacheStatsReply;
+#define sz_xXResQueryObjectCacheStatsReply 32
+
+typedef struct {
+    CARD32  screen;
+    CARD32  type;               /* atom: WINDOW, PIXMAP or GC */
+    CARD32  size;               /* bytes per object, privates included */
+    CARD32  cached;             /* free objects held */
+    CARD64  allocs;
+    CARD64  reused;             /* allocations served from the cache */
+} xXResObjectCacheStats;
+#define sz_xXResObjectCacheStats 32
+
+#endif                          /* XRESSTATS_H */
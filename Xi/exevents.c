@@ -681,9 +681,10 @@ void
 XISendDeviceChangedEvent(DeviceIntPtr device, DeviceChangedEvent *dce)
 {
     xXIDeviceChangedEvent *dcce;
-    int rc;
+    int rc, count;
 
-    rc = EventToXI2((InternalEvent *) dce, (xEvent **) &dcce);
+    rc = BorrowWireEvent((InternalEvent *) dce, XI2, (xEvent **) &dcce,
+                         &count);
     if (rc != Success) {
         ErrorF("[Xi] event conversion from DCE failed with code %d\n", rc);
         return;
@@ -692,7 +693,7 @@ XISendDeviceChangedEvent(DeviceIntPtr device, DeviceChangedEvent *dce)
     /* we don't actually swap if there's a NullClient, swapping is done
      * later when event is delivered. */
     SendEventToAllWindows(device, XI_DeviceChangedMask, (xEvent *) dcce, 1);
-    free(dcce);
+    ReleaseWireEvent((xEvent *) dcce);
 }
 
 static void
@@ -1006,7 +1007,7 @@ static Bool
 DeliverOneTouchEvent(ClientPtr client, DeviceIntPtr dev, TouchPointInfoPtr ti,
                      GrabPtr grab, WindowPtr win, InternalEvent *ev)
 {
-    int err;
+    int err, count;
     xEvent *xi2;
     Mask filter;
     Window child = DeepestSpriteWin(&ti->sprite)->drawable.id;
@@ -1020,17 +1021,19 @@ DeliverOneTouchEvent(ClientPtr client, DeviceIntPtr dev, TouchPointInfoPtr ti,
         return TRUE;
 
     /* If we fail here, we're going to leave a client hanging. */
-    err = EventToXI2(ev, &xi2);
+    err = BorrowWireEvent(ev, XI2, &xi2, &count);
     if (err != Success)
         FatalError("[Xi] %s: XI2 conversion failed in %s"
                    " (%d)\n", dev->name, __func__, err);
 
     FixUpEventFromWindow(&ti->sprite, xi2, win, child, FALSE);
     filter = GetEventFilter(dev, xi2);
-    if (XaceHook(XACE_RECEIVE_ACCESS, client, win, xi2, 1) != Success)
+    if (XaceHook(XACE_RECEIVE_ACCESS, client, win, xi2, 1) != Success) {
+        ReleaseWireEvent(xi2);
         return FALSE;
+    }
     err = TryClientEvents(client, dev, xi2, 1, filter, filter, NullGrab);
-    free(xi2);
+    ReleaseWireEvent(xi2);
 
     /* Returning the value from TryClientEvents isn't useful, since all our
      * resource-gone cleanups will update the delivery list anyway. */
@@ -1639,7 +1642,7 @@ ProcessBarrierEvent(InternalEvent *e, DeviceIntPtr dev)
     WindowPtr pWin;
     BarrierEvent *be = &e->barrier_event;
     xEvent *ev;
-    int rc;
+    int rc, count;
     GrabPtr grab = dev->deviceGrab.grab;
 
     if (!IsMaster(dev))
@@ -1651,7 +1654,7 @@ ProcessBarrierEvent(InternalEvent *e, DeviceIntPtr dev)
     if (grab)
         be->flags |= XIBarrierDeviceIsGrabbed;
 
-    rc = EventToXI2(e, &ev);
+    rc = BorrowWireEvent(e, XI2, &ev, &count);
     if (rc != Success) {
         ErrorF("[Xi] event conversion from %s failed with code %d\n", __func__, rc);
         return;
@@ -1672,7 +1675,7 @@ ProcessBarrierEvent(InternalEvent *e, DeviceIntPtr dev)
         DeliverEventsToWindow(dev, pWin, ev, 1,
                               filter, NullGrab);
     }
-    free(ev);
+    ReleaseWireEvent(ev);
 }
 
 /**
@@ -1740,10 +1743,10 @@ ProcessDeviceEvent(InternalEvent *ev, DeviceIntPtr device)
         xEvent *core;
         int count;
 
-        if (EventToCore(ev, &core, &count) == Success && count > 0) {
+        if (BorrowWireEvent(ev, CORE, &core, &count) == Success &&
+            count > 0)
             XaceHook(XACE_KEY_AVAIL, core, device, 0);
-            free(core);
-        }
+        ReleaseWireEvent(core);
     }
 
     if (DeviceEventCallback && !syncEvents.playingEvents) {
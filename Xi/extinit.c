@@ -710,7 +710,6 @@ SDeviceChangedEvent(xXIDeviceChangedEvent * from, xXIDeviceChangedEvent * to)
 static void
 SDeviceEvent(xXIDeviceEvent * from, xXIDeviceEvent * to)
 {
-    int i;
     char *ptr;
     char *vmask;
 
@@ -742,14 +741,9 @@ SDeviceEvent(xXIDeviceEvent * from, xXIDeviceEvent * to)
     ptr += from->buttons_len * 4;
     vmask = ptr;                /* valuator mask */
     ptr += from->valuators_len * 4;
-    for (i = 0; i < from->valuators_len * 32; i++) {
-        if (BitIsOn(vmask, i)) {
-            swapl(((uint32_t *) ptr));
-            ptr += 4;
-            swapl(((uint32_t *) ptr));
-            ptr += 4;
-        }
-    }
+    /* one FP3232 for each bit set */
+    SwapLongs((CARD32 *) ptr,
+              2 * CountBits((uint8_t *) vmask, from->valuators_len * 32));
 }
 
 static void
@@ -790,7 +784,6 @@ SXIPropertyEvent(xXIPropertyEvent * from, xXIPropertyEvent * to)
 static void
 SRawEvent(xXIRawEvent * from, xXIRawEvent * to)
 {
-    int i;
     FP3232 *values;
     unsigned char *mask;
 
@@ -806,21 +799,10 @@ SRawEvent(xXIRawEvent * from, xXIRawEvent * to)
     mask = (unsigned char *) &to[1];
     values = (FP3232 *) (mask + from->valuators_len * 4);
 
-    for (i = 0; i < from->valuators_len * 4 * 8; i++) {
-        if (BitIsOn(mask, i)) {
-            /* for each bit set there are two FP3232 values on the wire, in
-             * the order abcABC for data and data_raw. Here we swap as if
-             * they were in aAbBcC order because it's easier and really
-             * doesn't matter.
-             */
-            swapl(&values->integral);
-            swapl(&values->frac);
-            values++;
-            swapl(&values->integral);
-            swapl(&values->frac);
-            values++;
-        }
-    }
+    /* for each bit set there are two FP3232 values on the wire, for data
+     * and data_raw, and all of them are swapped the same way. */
+    SwapLongs((CARD32 *) values,
+              4 * CountBits(mask, from->valuators_len * 32));
 
     swaps(&to->valuators_len);
 }
@@ -1197,11 +1179,18 @@ AssignTypeAndName(DeviceIntPtr dev, Atom type, const char *name)
 static void
 MakeDeviceTypeAtoms(void)
 {
+    const char *names[NUMTYPES];
+    unsigned lens[NUMTYPES];
+    Atom atoms[NUMTYPES];
     int i;
 
+    for (i = 0; i < NUMTYPES; i++) {
+        names[i] = dev_type[i].name;
+        lens[i] = strlen(dev_type[i].name);
+    }
+    MakeAtoms(names, lens, NUMTYPES, TRUE, atoms);
     for (i = 0; i < NUMTYPES; i++)
-        dev_type[i].type =
-            MakeAtom(dev_type[i].name, strlen(dev_type[i].name), 1);
+        dev_type[i].type = atoms[i];
 }
 
 /*****************************************************************************
@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+/*
+ * Linux USDT implementation of the Xserver provider described in
+ * Xserver.d, used instead of the dtrace(1) generated header when
+ * building with --enable-sdt.
+ *
+ * Every probe has a semaphore that tracing tools (bpftrace, perf,
+ * systemtap) increment while attached, so the _ENABLED() checks are a
+ * single predictable load and argument setup is skipped otherwise.
+ * The probe sites themselves compile to a nop.
+ */
+
+#ifndef _XSERVER_SDT_H
+#define _XSERVER_SDT_H
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define XSERVER_SDT_PROBES(PROBE) \
+	PROBE(request__start) \
+	PROBE(request__done) \
+	PROBE(client__connect) \
+	PROBE(client__auth) \
+	PROBE(client__disconnect) \
+	PROBE(resource__alloc) \
+	PROBE(resource__free) \
+	PROBE(send__event) \
+	PROBE(input__event) \
+	PROBE(wait__wakeup) \
+	PROBE(flush__client) \
+	PROBE(damage__append) \
+	PROBE(input__process) \
+	PROBE(repaint__start) \
+	PROBE(repaint__done)
+
+#define XSERVER_SDT_SEMAPHORE(name) Xserver_##name##_semaphore
+
+#define XSERVER_SDT_DECLARE_SEMAPHORE(name) \
+	__extension__ extern unsigned short XSERVER_SDT_SEMAPHORE(name) \
+	__attribute__ ((unused)) __attribute__ ((section (".probes")));
+
+XSERVER_SDT_PROBES(XSERVER_SDT_DECLARE_SEMAPHORE)
+
+#define XSERVER_SDT_ENABLED(name) \
+	__builtin_expect (XSERVER_SDT_SEMAPHORE(name), 0)
+
+#define	XSERVER_REQUEST_START(arg0, arg1, arg2, arg3, arg4) \
+	DTRACE_PROBE5(Xserver, request__start, arg0, arg1, arg2, arg3, arg4)
+#define	XSERVER_REQUEST_DONE(arg0, arg1, arg2, arg3, arg4) \
+	DTRACE_PROBE5(Xserver, request__done, arg0, arg1, arg2, arg3, arg4)
+#define	XSERVER_CLIENT_CONNECT(arg0, arg1) \
+	DTRACE_PROBE2(Xserver, client__connect, arg0, arg1)
+#define	XSERVER_CLIENT_AUTH(arg0, arg1, arg2, arg3) \
+	DTRACE_PROBE4(Xserver, client__auth, arg0, arg1, arg2, arg3)
+#define	XSERVER_CLIENT_DISCONNECT(arg0) \
+	DTRACE_PROBE1(Xserver, client__disconnect, arg0)
+#define	XSERVER_RESOURCE_ALLOC(arg0, arg1, arg2, arg3) \
+	DTRACE_PROBE4(Xserver, resource__alloc, arg0, arg1, arg2, arg3)
+#define	XSERVER_RESOURCE_FREE(arg0, arg1, arg2, arg3) \
+	DTRACE_PROBE4(Xserver, resource__free, arg0, arg1, arg2, arg3)
+#define	XSERVER_SEND_EVENT(arg0, arg1, arg2) \
+	DTRACE_PROBE3(Xserver, send__event, arg0, arg1, arg2)
+#define	XSERVER_INPUT_EVENT(arg0, arg1, arg2, arg3, arg4, arg5, arg6) \
+	DTRACE_PROBE7(Xserver, input__event, arg0, arg1, arg2, arg3, arg4, arg5, arg6)
+#define	XSERVER_WAIT_WAKEUP(arg0, arg1) \
+	DTRACE_PROBE2(Xserver, wait__wakeup, arg0, arg1)
+#define	XSERVER_FLUSH_CLIENT(arg0, arg1) \
+	DTRACE_PROBE2(Xserver, flush__client, arg0, arg1)
+#define	XSERVER_DAMAGE_APPEND(arg0, arg1, arg2, arg3, arg4, arg5) \
+	DTRACE_PROBE6(Xserver, damage__append, arg0, arg1, arg2, arg3, arg4, arg5)
+#define	XSERVER_INPUT_PROCESS(arg0, arg1, arg2) \
+	DTRACE_PROBE3(Xserver, input__process, arg0, arg1, arg2)
+#define	XSERVER_REPAINT_START(arg0, arg1) \
+	DTRACE_PROBE2(Xserver, repaint__start, arg0, arg1)
+#define	XSERVER_REPAINT_DONE(arg0) \
+	DTRACE_PROBE1(Xserver, repaint__done, arg0)
+
+#define	XSERVER_REQUEST_START_ENABLED() XSERVER_SDT_ENABLED(request__start)
+#define	XSERVER_REQUEST_DONE_ENABLED() XSERVER_SDT_ENABLED(request__done)
+#define	XSERVER_CLIENT_CONNECT_ENABLED() XSERVER_SDT_ENABLED(client__connect)
+#define	XSERVER_CLIENT_AUTH_ENABLED() XSERVER_SDT_ENABLED(client__auth)
+#define	XSERVER_CLIENT_DISCONNECT_ENABLED() XSERVER_SDT_ENABLED(client__disconnect)
+#define	XSERVER_RESOURCE_ALLOC_ENABLED() XSERVER_SDT_ENABLED(resource__alloc)
+#define	XSERVER_RESOURCE_FREE_ENABLED() XSERVER_SDT_ENABLED(resource__free)
+#define	XSERVER_SEND_EVENT_ENABLED() XSERVER_SDT_ENABLED(send__event)
+#define	XSERVER_INPUT_EVENT_ENABLED() XSERVER_SDT_ENABLED(input__event)
+#define	XSERVER_WAIT_WAKEUP_ENABLED() XSERVER_SDT_ENABLED(wait__wakeup)
+#define	XSERVER_FLUSH_CLIENT_ENABLED() XSERVER_SDT_ENABLED(flush__client)
+#define	XSERVER_DAMAGE_APPEND_ENABLED() XSERVER_SDT_ENABLED(damage__append)
+#define	XSERVER_INPUT_PROCESS_ENABLED() XSERVER_SDT_ENABLED(input__process)
+#define	XSERVER_REPAINT_START_ENABLED() XSERVER_SDT_ENABLED(repaint__start)
+#define	XSERVER_REPAINT_DONE_ENABLED() XSERVER_SDT_ENABLED(repaint__done)
+
+#endif                          /* _XSERVER_SDT_H */
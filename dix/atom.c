@@ -57,87 +57,209 @@ SOFTWARE.
 #include "dix.h"
 
 #define InitialTableSize 256
+#define InitialHashSize 512
+
+/*
+ * Atoms are found by name through an open addressing hash table, probed
+ * linearly and kept at most half full.  Each slot holds the full name
+ * hash next to the atom so that probing past other names rarely touches
+ * their nodes.  Atoms are never freed individually, so the table needs
+ * no deletion markers.  nodeTable maps atom numbers back to their nodes
+ * for NameForAtom.
+ */
 
 typedef struct _Node {
-    struct _Node *left, *right;
     Atom a;
-    unsigned int fingerPrint;
-    const char *string;
+    unsigned int len;
+    const char *string;         /* follows the node, unless predefined */
 } NodeRec, *NodePtr;
 
+typedef struct _AtomSlot {
+    CARD32 hash;
+    Atom a;
+} AtomSlotRec, *AtomSlotPtr;
+
 static Atom lastAtom = None;
-static NodePtr atomRoot = NULL;
 static unsigned long tableLength;
 static NodePtr *nodeTable;
+static AtomSlotPtr atomHash;
+static unsigned int atomHashMask;
 
-Atom
-MakeAtom(const char *string, unsigned len, Bool makeit)
+/* FNV-1a, finished with the murmur3 mixer so that all bits avalanche */
+static inline unsigned int
+HashAtomName(const char *string, unsigned len)
 {
-    NodePtr *np;
+    CARD32 h = 2166136261U;
     unsigned i;
-    int comp;
-    unsigned int fp = 0;
 
-    np = &atomRoot;
-    for (i = 0; i < (len + 1) / 2; i++) {
-        fp = fp * 27 + string[i];
-        fp = fp * 27 + string[len - 1 - i];
+    for (i = 0; i < len; i++) {
+        h ^= (unsigned char) string[i];
+        h *= 16777619U;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+/*
+ * Return the atom named by string, or None with *slot set to the free
+ * hash slot where it would be inserted.
+ */
+static inline Atom
+FindAtom(const char *string, unsigned len, unsigned int hash,
+         unsigned int *slot)
+{
+    unsigned int i = hash & atomHashMask;
+    Atom a;
+
+    while ((a = atomHash[i].a) != None) {
+        if (atomHash[i].hash == hash) {
+            NodePtr nd = nodeTable[a];
+
+            if (nd->len == len && memcmp(nd->string, string, len) == 0)
+                return a;
+        }
+        i = (i + 1) & atomHashMask;
+    }
+    *slot = i;
+    return None;
+}
+
+/*
+ * Make room for count more atoms, growing both nodeTable and the hash
+ * table at most once.
+ */
+static Bool
+ReserveAtoms(unsigned count)
+{
+    unsigned long need = lastAtom + 1 + count;
+    unsigned int size = atomHashMask + 1;
+
+    if (need > tableLength) {
+        unsigned long length = tableLength;
+        NodePtr *table;
+
+        while (need > length)
+            length <<= 1;
+        table = reallocarray(nodeTable, length, sizeof(NodePtr));
+        if (!table)
+            return FALSE;
+        tableLength = length;
+        nodeTable = table;
     }
-    while (*np != NULL) {
-        if (fp < (*np)->fingerPrint)
-            np = &((*np)->left);
-        else if (fp > (*np)->fingerPrint)
-            np = &((*np)->right);
-        else {                  /* now start testing the strings */
-            comp = strncmp(string, (*np)->string, (int) len);
-            if ((comp < 0) || ((comp == 0) && (len < strlen((*np)->string))))
-                np = &((*np)->left);
-            else if (comp > 0)
-                np = &((*np)->right);
-            else
-                return (*np)->a;
+
+    if (need * 2 > size) {
+        AtomSlotPtr hash;
+        unsigned int j;
+
+        while (need * 2 > size)
+            size <<= 1;
+        hash = calloc(size, sizeof(AtomSlotRec));
+        if (!hash)
+            return FALSE;
+        for (j = 0; j <= atomHashMask; j++) {
+            unsigned int i = atomHash[j].hash & (size - 1);
+
+            if (atomHash[j].a == None)
+                continue;
+            while (hash[i].a != None)
+                i = (i + 1) & (size - 1);
+            hash[i] = atomHash[j];
         }
+        free(atomHash);
+        atomHash = hash;
+        atomHashMask = size - 1;
     }
-    if (makeit) {
-        NodePtr nd;
+    return TRUE;
+}
+
+/*
+ * Create a new atom in the hash slot returned by FindAtom.  The caller
+ * must have reserved room for it.
+ */
+static Atom
+InsertAtom(const char *string, unsigned len, unsigned int hash,
+           unsigned int slot)
+{
+    NodePtr nd;
 
+    if (lastAtom < XA_LAST_PREDEFINED) {
         nd = malloc(sizeof(NodeRec));
         if (!nd)
             return BAD_RESOURCE;
-        if (lastAtom < XA_LAST_PREDEFINED) {
-            nd->string = string;
-        }
-        else {
-            nd->string = strndup(string, len);
-            if (!nd->string) {
-                free(nd);
-                return BAD_RESOURCE;
-            }
-        }
-        if ((lastAtom + 1) >= tableLength) {
-            NodePtr *table;
-
-            table = reallocarray(nodeTable, tableLength, 2 * sizeof(NodePtr));
-            if (!table) {
-                if (nd->string != string) {
-                    /* nd->string has been strdup'ed */
-                    free((char *) nd->string);
-                }
-                free(nd);
-                return BAD_RESOURCE;
-            }
-            tableLength <<= 1;
-            nodeTable = table;
-        }
-        *np = nd;
-        nd->left = nd->right = NULL;
-        nd->fingerPrint = fp;
-        nd->a = ++lastAtom;
-        nodeTable[lastAtom] = nd;
-        return nd->a;
+        nd->string = string;
     }
-    else
-        return None;
+    else {
+        nd = malloc(sizeof(NodeRec) + len + 1);
+        if (!nd)
+            return BAD_RESOURCE;
+        memcpy(&nd[1], string, len);
+        ((char *) &nd[1])[len] = '\0';
+        nd->string = (const char *) &nd[1];
+    }
+    nd->len = len;
+    nd->a = ++lastAtom;
+    nodeTable[lastAtom] = nd;
+    atomHash[slot].hash = hash;
+    atomHash[slot].a = nd->a;
+    return nd->a;
+}
+
+Atom
+MakeAtom(const char *string, unsigned len, Bool makeit)
+{
+    unsigned int hash, slot;
+    Atom a;
+
+    /* Names stop at the first NUL, as they always have */
+    len = strnlen(string, len);
+    hash = HashAtomName(string, len);
+    a = FindAtom(string, len, hash, &slot);
+    if (a != None || !makeit)
+        return a;
+
+    if (!ReserveAtoms(1))
+        return BAD_RESOURCE;
+    /* The hash table may have been rebuilt, so find the free slot again */
+    FindAtom(string, len, hash, &slot);
+    return InsertAtom(string, len, hash, slot);
+}
+
+/**
+ * Look up or create count atoms at once, storing the results in atoms.
+ * Tables are grown once for the whole batch rather than as each atom is
+ * added.  Entries that fail to allocate are set to BAD_RESOURCE and
+ * FALSE is returned.
+ */
+Bool
+MakeAtoms(const char **strings, const unsigned *lens, unsigned count,
+          Bool makeit, Atom *atoms)
+{
+    Bool ok = TRUE, reserved = FALSE;
+    unsigned i;
+
+    if (makeit)
+        reserved = ReserveAtoms(count);
+
+    for (i = 0; i < count; i++) {
+        unsigned len = strnlen(strings[i], lens[i]);
+        unsigned int hash = HashAtomName(strings[i], len);
+        unsigned int slot;
+
+        atoms[i] = FindAtom(strings[i], len, hash, &slot);
+        if (atoms[i] != None || !makeit)
+            continue;
+        if (reserved)
+            atoms[i] = InsertAtom(strings[i], len, hash, slot);
+        else
+            atoms[i] = MakeAtom(strings[i], len, TRUE);
+        if (atoms[i] == BAD_RESOURCE)
+            ok = FALSE;
+    }
+    return ok;
 }
 
 Bool
@@ -164,32 +286,21 @@ AtomError(void)
     FatalError("initializing atoms");
 }
 
-static void
-FreeAtom(NodePtr patom)
-{
-    if (patom->left)
-        FreeAtom(patom->left);
-    if (patom->right)
-        FreeAtom(patom->right);
-    if (patom->a > XA_LAST_PREDEFINED) {
-        /*
-         * All strings above XA_LAST_PREDEFINED are strdup'ed, so it's safe to
-         * cast here
-         */
-        free((char *) patom->string);
-    }
-    free(patom);
-}
-
 void
 FreeAllAtoms(void)
 {
-    if (atomRoot == NULL)
+    Atom a;
+
+    if (nodeTable == NULL)
         return;
-    FreeAtom(atomRoot);
-    atomRoot = NULL;
+    /* Names are stored in the nodes themselves */
+    for (a = 1; a <= lastAtom; a++)
+        free(nodeTable[a]);
     free(nodeTable);
     nodeTable = NULL;
+    free(atomHash);
+    atomHash = NULL;
+    atomHashMask = 0;
     lastAtom = None;
 }
 
@@ -202,6 +313,10 @@ InitAtoms(void)
     if (!nodeTable)
         AtomError();
     nodeTable[None] = NULL;
+    atomHash = calloc(InitialHashSize, sizeof(AtomSlotRec));
+    if (!atomHash)
+        AtomError();
+    atomHashMask = InitialHashSize - 1;
     MakePredeclaredAtoms();
     if (lastAtom != XA_LAST_PREDEFINED)
         AtomError();
@@ -228,6 +228,190 @@ typedef struct _colorResource {
  * fShared should only be set if refcnt == AllocPrivate, and only in red map
  */
 
+/*
+ * Cells are found by colour through a chained hash per channel: heads
+ * maps a bucket to the first pixel in it and next links the pixels of a
+ * bucket, so the index costs two ints per cell.  Dynamic maps index the
+ * cells with refcnt > 0, the only ones FindColor may share and whose
+ * colour can no longer change; StoreColors only writes private cells.
+ * Static maps never change once created and index every cell.  The index
+ * is built from the entries on first use, so cells filled in before then,
+ * or while it could not be allocated, are not lost.
+ */
+
+#define NOT_INDEXED (-2)
+
+/* Single map classes keep all cells in red, whatever channel the caller
+ * names them by */
+#define IndexChannel(pmap, channel) \
+    (((pmap)->class | DynamicClass) == DirectColor ? (channel) : PSEUDOMAP)
+#define IndexSlot(channel) ((channel) == PSEUDOMAP ? REDMAP : (channel))
+
+typedef struct _ColorIndex {
+    unsigned mask;              /* number of buckets - 1 */
+    int *heads[3];
+    int *next[3];
+} ColorIndexRec;
+
+static unsigned
+HashColor(ColorIndexPtr index, xrgb * prgb, int channel)
+{
+    CARD32 h;
+
+    switch (channel) {
+    case REDMAP:
+        h = prgb->red;
+        break;
+    case GREENMAP:
+        h = prgb->green;
+        break;
+    case BLUEMAP:
+        h = prgb->blue;
+        break;
+    default:                   /* PSEUDOMAP */
+        h = prgb->red ^ ((CARD32) prgb->green << 16) ^
+            (prgb->blue * 0x85ebca6bU);
+        break;
+    }
+    h *= 0x9e3779b1U;
+    h ^= h >> 16;
+    return h & index->mask;
+}
+
+static void
+EntryColor(EntryPtr pent, xrgb * prgb)
+{
+    prgb->red = pent->co.local.red;
+    prgb->green = pent->co.local.green;
+    prgb->blue = pent->co.local.blue;
+}
+
+static EntryPtr
+IndexEntries(ColormapPtr pmap, int slot)
+{
+    switch (slot) {
+    case GREENMAP:
+        return pmap->green;
+    case BLUEMAP:
+        return pmap->blue;
+    default:
+        return pmap->red;
+    }
+}
+
+/* Add a cell to the index, if there is one yet */
+static void
+IndexCell(ColormapPtr pmap, int mapChannel, Pixel pixel)
+{
+    ColorIndexPtr index = pmap->index;
+    int channel = IndexChannel(pmap, mapChannel);
+    int slot = IndexSlot(channel);
+    unsigned bucket;
+    xrgb rgb;
+
+    if (!index || index->next[slot][pixel] != NOT_INDEXED)
+        return;
+    EntryColor(IndexEntries(pmap, slot) + pixel, &rgb);
+    bucket = HashColor(index, &rgb, channel);
+    index->next[slot][pixel] = index->heads[slot][bucket];
+    index->heads[slot][bucket] = pixel;
+}
+
+static void
+UnindexCell(ColormapPtr pmap, int mapChannel, Pixel pixel)
+{
+    ColorIndexPtr index = pmap->index;
+    int channel = IndexChannel(pmap, mapChannel);
+    int slot = IndexSlot(channel);
+    int *link;
+    xrgb rgb;
+
+    if (!index || index->next[slot][pixel] == NOT_INDEXED)
+        return;
+    EntryColor(IndexEntries(pmap, slot) + pixel, &rgb);
+    link = &index->heads[slot][HashColor(index, &rgb, channel)];
+    while (*link != pixel)
+        link = &index->next[slot][*link];
+    *link = index->next[slot][pixel];
+    index->next[slot][pixel] = NOT_INDEXED;
+}
+
+/*
+ * Return the index of pmap, building it if needed.  Returns NULL while
+ * the map is being created, since cells are then filled in one by one
+ * rather than shared, or if memory runs out; callers then search the
+ * entries themselves.
+ */
+static ColorIndexPtr
+GetColorIndex(ColormapPtr pmap)
+{
+    ColorIndexPtr index;
+    int size, nslots, slot, i, *p;
+    unsigned nbuckets;
+    Bool all;
+
+    if (pmap->index)
+        return pmap->index;
+    if (pmap->flags & BeingCreated)
+        return NULL;
+
+    size = pmap->pVisual->ColormapEntries;
+    nslots = ((pmap->class | DynamicClass) == DirectColor) ? 3 : 1;
+    for (nbuckets = 16; nbuckets < (unsigned) size; nbuckets <<= 1);
+    index = malloc(sizeof(ColorIndexRec) +
+                   nslots * (nbuckets + size) * sizeof(int));
+    if (!index)
+        return NULL;
+    index->mask = nbuckets - 1;
+    p = (int *) &index[1];
+    for (slot = 0; slot < nslots; slot++) {
+        index->heads[slot] = p;
+        p += nbuckets;
+        index->next[slot] = p;
+        p += size;
+        for (i = 0; i < nbuckets; i++)
+            index->heads[slot][i] = -1;
+        for (i = 0; i < size; i++)
+            index->next[slot][i] = NOT_INDEXED;
+    }
+    pmap->index = index;
+
+    /* Insert from the top so that each chain lists its lowest pixel
+     * first, as FindBestPixel would pick it */
+    all = !(pmap->class & DynamicClass);
+    for (slot = 0; slot < nslots; slot++) {
+        EntryPtr pent = IndexEntries(pmap, slot);
+        int channel = (nslots == 1) ? PSEUDOMAP : slot;
+
+        for (i = size; --i >= 0;)
+            if (all || pent[i].refcnt > 0)
+                IndexCell(pmap, channel, i);
+    }
+    return index;
+}
+
+/* Find an indexed cell of the colour prgb, leaving *pPixel alone if
+ * there is none */
+static Bool
+FindIndexedColor(ColormapPtr pmap, xrgb * prgb, int mapChannel,
+                 ColorCompareProcPtr comp, Pixel * pPixel)
+{
+    ColorIndexPtr index = pmap->index;
+    int channel = IndexChannel(pmap, mapChannel);
+    int slot = IndexSlot(channel);
+    EntryPtr pentFirst = IndexEntries(pmap, slot);
+    int pixel;
+
+    for (pixel = index->heads[slot][HashColor(index, prgb, channel)];
+         pixel >= 0; pixel = index->next[slot][pixel]) {
+        if ((*comp) (pentFirst + pixel, prgb)) {
+            *pPixel = pixel;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 /**
  * Create and initialize the color map
  *
@@ -285,6 +469,7 @@ CreateColormap(Colormap mid, ScreenPtr pScreen, VisualPtr pVisual,
     pmap->pScreen = pScreen;
     pmap->pVisual = pVisual;
     pmap->class = class;
+    pmap->index = NULL;
     if ((class | DynamicClass) == DirectColor)
         size = NUMRED(pVisual);
     pmap->freeRed = size;
@@ -440,6 +625,8 @@ FreeColormap(void *value, XID mid)
         }
     }
 
+    free(pmap->index);
+
     if (pmap->flags & IsDefault) {
         dixFreePrivates(pmap->devPrivates, PRIVATE_COLORMAP);
         free(pmap);
@@ -613,8 +800,10 @@ CopyFree(int channel, int client, ColormapPtr pmapSrc, ColormapPtr pmapDst)
             else {
                 *pentDst = *pentSrc;
                 nalloc++;
-                if (pentSrc->refcnt > 0)
+                if (pentSrc->refcnt > 0) {
                     pentDst->refcnt = 1;
+                    IndexCell(pmapDst, channel, *ppix);
+                }
                 else
                     pentSrc->fShared = FALSE;
             }
@@ -678,6 +867,8 @@ FreeCell(ColormapPtr pmap, Pixel i, int channel)
     if (pent->refcnt > 1)
         pent->refcnt--;
     else {
+        if (pent->refcnt == 1)
+            UnindexCell(pmap, channel, i);
         /* If the color type is shared, find the sharedcolor. If decremented
          * refcnt is 0, free the shared cell. */
         if (pent->fShared) {
@@ -761,54 +952,85 @@ FindColor(ColormapPtr pmap, EntryPtr pentFirst, int size, xrgb * prgb,
           Pixel * pPixel, int channel, int client, ColorCompareProcPtr comp)
 {
     EntryPtr pent;
-    Bool foundFree;
+    Bool found, foundFree;
     Pixel pixel, Free = 0;
     int npix, count, *nump = NULL;
     Pixel **pixp = NULL, *ppix;
     xColorItem def;
 
-    foundFree = FALSE;
+    found = foundFree = FALSE;
 
     if ((pixel = *pPixel) >= size)
         pixel = 0;
-    /* see if there is a match, and also look for a free entry */
-    for (pent = pentFirst + pixel, count = size; --count >= 0;) {
-        if (pent->refcnt > 0) {
-            if ((*comp) (pent, prgb)) {
-                if (client >= 0)
-                    pent->refcnt++;
-                *pPixel = pixel;
-                switch (channel) {
-                case REDMAP:
-                    *pPixel <<= pmap->pVisual->offsetRed;
-                case PSEUDOMAP:
-                    break;
-                case GREENMAP:
-                    *pPixel <<= pmap->pVisual->offsetGreen;
-                    break;
-                case BLUEMAP:
-                    *pPixel <<= pmap->pVisual->offsetBlue;
+    pent = pentFirst + pixel;
+    if (GetColorIndex(pmap)) {
+        /* Keep the requested pixel if it matches, else share any cell of
+         * this colour, and only then walk the map for a free entry */
+        if ((pent->refcnt > 0 && (*comp) (pent, prgb)) ||
+            FindIndexedColor(pmap, prgb, channel, comp, &pixel)) {
+            pent = pentFirst + pixel;
+            found = TRUE;
+        }
+        for (count = size; !found && --count >= 0;) {
+            if (pent->refcnt == 0) {
+                Free = pixel;
+                foundFree = TRUE;
+                break;
+            }
+            pixel++;
+            if (pixel >= size) {
+                pent = pentFirst;
+                pixel = 0;
+            }
+            else
+                pent++;
+        }
+    }
+    else {
+        /* see if there is a match, and also look for a free entry */
+        for (count = size; --count >= 0;) {
+            if (pent->refcnt > 0) {
+                if ((*comp) (pent, prgb)) {
+                    found = TRUE;
                     break;
                 }
-                goto gotit;
             }
+            else if (!foundFree && pent->refcnt == 0) {
+                Free = pixel;
+                foundFree = TRUE;
+                /* If we're initializing the colormap, then we are looking
+                 * for the first free cell we can find, not to minimize the
+                 * number of entries we use.  So don't look any further. */
+                if (pmap->flags & BeingCreated)
+                    break;
+            }
+            pixel++;
+            if (pixel >= size) {
+                pent = pentFirst;
+                pixel = 0;
+            }
+            else
+                pent++;
         }
-        else if (!foundFree && pent->refcnt == 0) {
-            Free = pixel;
-            foundFree = TRUE;
-            /* If we're initializing the colormap, then we are looking for
-             * the first free cell we can find, not to minimize the number
-             * of entries we use.  So don't look any further. */
-            if (pmap->flags & BeingCreated)
-                break;
-        }
-        pixel++;
-        if (pixel >= size) {
-            pent = pentFirst;
-            pixel = 0;
+    }
+
+    if (found) {
+        if (client >= 0)
+            pent->refcnt++;
+        *pPixel = pixel;
+        switch (channel) {
+        case REDMAP:
+            *pPixel <<= pmap->pVisual->offsetRed;
+        case PSEUDOMAP:
+            break;
+        case GREENMAP:
+            *pPixel <<= pmap->pVisual->offsetGreen;
+            break;
+        case BLUEMAP:
+            *pPixel <<= pmap->pVisual->offsetBlue;
+            break;
         }
-        else
-            pent++;
+        goto gotit;
     }
 
     /* If we got here, we didn't find a match.  If we also didn't find
@@ -867,6 +1089,8 @@ FindColor(ColormapPtr pmap, EntryPtr pentFirst, int size, xrgb * prgb,
         def.pixel = Free << pmap->pVisual->offsetBlue;
         break;
     }
+    if (client >= 0)
+        IndexCell(pmap, channel, Free);
     (*pmap->pScreen->StoreColors) (pmap, 1, &def);
     pixel = Free;
     *pPixel = def.pixel;
@@ -895,7 +1119,8 @@ FindColor(ColormapPtr pmap, EntryPtr pentFirst, int size, xrgb * prgb,
     npix = nump[client];
     ppix = reallocarray(pixp[client], npix + 1, sizeof(Pixel));
     if (!ppix) {
-        pent->refcnt--;
+        if (--pent->refcnt == 0)
+            UnindexCell(pmap, channel, pixel);
         if (!pent->fShared)
             switch (channel) {
             case PSEUDOMAP:
@@ -918,7 +1143,22 @@ FindColor(ColormapPtr pmap, EntryPtr pentFirst, int size, xrgb * prgb,
     return Success;
 }
 
-/* Get a read-only color from a ColorMap (probably slow for large maps)
+/* Find the cell of a static map closest to prgb.  Resolved colours
+ * usually match a cell exactly, which the index finds without measuring
+ * the distance to every cell */
+static Pixel
+FindClosestPixel(ColormapPtr pmap, EntryPtr pentFirst, int size, xrgb * prgb,
+                 int channel, ColorCompareProcPtr comp)
+{
+    Pixel pixel;
+
+    if (GetColorIndex(pmap) &&
+        FindIndexedColor(pmap, prgb, channel, comp, &pixel))
+        return pixel;
+    return FindBestPixel(pentFirst, size, prgb, channel);
+}
+
+/* Get a read-only color from a ColorMap
  * Returns by changing the value in pred, pgreen, pblue and pPix
  */
 int
@@ -957,7 +1197,8 @@ AllocColor(ColormapPtr pmap,
     case StaticColor:
     case StaticGray:
         /* Look up all three components in the same pmap */
-        *pPix = pixR = FindBestPixel(pmap->red, entries, &rgb, PSEUDOMAP);
+        *pPix = pixR = FindClosestPixel(pmap, pmap->red, entries, &rgb,
+                                        PSEUDOMAP, AllComp);
         *pred = pmap->red[pixR].co.local.red;
         *pgreen = pmap->red[pixR].co.local.green;
         *pblue = pmap->red[pixR].co.local.blue;
@@ -973,9 +1214,12 @@ AllocColor(ColormapPtr pmap,
 
     case TrueColor:
         /* Look up each component in its own map, then OR them together */
-        pixR = FindBestPixel(pmap->red, NUMRED(pVisual), &rgb, REDMAP);
-        pixG = FindBestPixel(pmap->green, NUMGREEN(pVisual), &rgb, GREENMAP);
-        pixB = FindBestPixel(pmap->blue, NUMBLUE(pVisual), &rgb, BLUEMAP);
+        pixR = FindClosestPixel(pmap, pmap->red, NUMRED(pVisual), &rgb,
+                                REDMAP, RedComp);
+        pixG = FindClosestPixel(pmap, pmap->green, NUMGREEN(pVisual), &rgb,
+                                GREENMAP, GreenComp);
+        pixB = FindClosestPixel(pmap, pmap->blue, NUMBLUE(pVisual), &rgb,
+                                BLUEMAP, BlueComp);
         *pPix = (pixR << pVisual->offsetRed) |
             (pixG << pVisual->offsetGreen) |
             (pixB << pVisual->offsetBlue) | ALPHAMASK(pVisual);
@@ -1132,7 +1376,8 @@ FakeAllocColor(ColormapPtr pmap, xColorItem * item)
         /* fall through ... */
     case StaticColor:
     case StaticGray:
-        item->pixel = FindBestPixel(pmap->red, entries, &rgb, PSEUDOMAP);
+        item->pixel = FindClosestPixel(pmap, pmap->red, entries, &rgb,
+                                       PSEUDOMAP, AllComp);
         break;
 
     case DirectColor:
@@ -1157,9 +1402,12 @@ FakeAllocColor(ColormapPtr pmap, xColorItem * item)
 
     case TrueColor:
         /* Look up each component in its own map, then OR them together */
-        pixR = FindBestPixel(pmap->red, NUMRED(pVisual), &rgb, REDMAP);
-        pixG = FindBestPixel(pmap->green, NUMGREEN(pVisual), &rgb, GREENMAP);
-        pixB = FindBestPixel(pmap->blue, NUMBLUE(pVisual), &rgb, BLUEMAP);
+        pixR = FindClosestPixel(pmap, pmap->red, NUMRED(pVisual), &rgb,
+                                REDMAP, RedComp);
+        pixG = FindClosestPixel(pmap, pmap->green, NUMGREEN(pVisual), &rgb,
+                                GREENMAP, GreenComp);
+        pixB = FindClosestPixel(pmap, pmap->blue, NUMBLUE(pVisual), &rgb,
+                                BLUEMAP, BlueComp);
         item->pixel = (pixR << pVisual->offsetRed) |
             (pixG << pVisual->offsetGreen) | (pixB << pVisual->offsetBlue);
         break;
@@ -1276,6 +1524,21 @@ FindBestPixel(EntryPtr pentFirst, int size, xrgb * prgb, int channel)
     return final;
 }
 
+static Pixel
+ShiftChannelPixel(ColormapPtr pmap, Pixel pixel, int channel)
+{
+    switch (channel) {
+    case REDMAP:
+        return pixel << pmap->pVisual->offsetRed;
+    case GREENMAP:
+        return pixel << pmap->pVisual->offsetGreen;
+    case BLUEMAP:
+        return pixel << pmap->pVisual->offsetBlue;
+    default:                   /* PSEUDOMAP */
+        return pixel;
+    }
+}
+
 static void
 FindColorInRootCmap(ColormapPtr pmap, EntryPtr pentFirst, int size,
                     xrgb * prgb, Pixel * pPixel, int channel,
@@ -1285,25 +1548,16 @@ FindColorInRootCmap(ColormapPtr pmap, EntryPtr pentFirst, int size,
     Pixel pixel;
     int count;
 
+    if (GetColorIndex(pmap)) {
+        if (FindIndexedColor(pmap, prgb, channel, comp, &pixel))
+            *pPixel = ShiftChannelPixel(pmap, pixel, channel);
+        return;
+    }
     if ((pixel = *pPixel) >= size)
         pixel = 0;
     for (pent = pentFirst + pixel, count = size; --count >= 0; pent++, pixel++) {
-        if (pent->refcnt > 0 && (*comp) (pent, prgb)) {
-            switch (channel) {
-            case REDMAP:
-                pixel <<= pmap->pVisual->offsetRed;
-                break;
-            case GREENMAP:
-                pixel <<= pmap->pVisual->offsetGreen;
-                break;
-            case BLUEMAP:
-                pixel <<= pmap->pVisual->offsetBlue;
-                break;
-            default:           /* PSEUDOMAP */
-                break;
-            }
-            *pPixel = pixel;
-        }
+        if (pent->refcnt > 0 && (*comp) (pent, prgb))
+            *pPixel = ShiftChannelPixel(pmap, pixel, channel);
     }
 }
 
@@ -134,6 +134,10 @@ DeviceSetTransform(DeviceIntPtr dev, float *transform_data)
 
     pixman_f_transform_multiply(&dev->scale_and_transform, &dev->scale_and_transform, &scale);
 
+    if (!pixman_f_transform_invert(&dev->scale_and_transform_inverse,
+                                   &dev->scale_and_transform))
+        pixman_f_transform_init_identity(&dev->scale_and_transform_inverse);
+
     /* remove translation component for relative movements */
     dev->relative_transform = transform;
     dev->relative_transform.m[0][2] = 0;
@@ -320,6 +324,7 @@ AddInputDevice(ClientPtr client, DeviceProc deviceProc, Bool autoStart)
     dev->relative_transform.m[1][1] = 1.0;
     dev->relative_transform.m[2][2] = 1.0;
     dev->scale_and_transform = dev->relative_transform;
+    dev->scale_and_transform_inverse = dev->relative_transform;
 
     XIChangeDeviceProperty(dev, XIGetKnownProperty(XI_PROP_TRANSFORM),
                            XIGetKnownProperty(XATOM_FLOAT), 32,
@@ -129,6 +129,7 @@ int ProcInitialConnection();
 #include "xkbsrv.h"
 #include "site.h"
 #include "client.h"
+#include "reqstats.h"
 
 #ifdef XSERVER_DTRACE
 #include "registry.h"
@@ -425,11 +426,37 @@ Dispatch(void)
                 if (result > (maxBigRequestSize << 2))
                     result = BadLength;
                 else {
+                    Bool stats = ReqStatsEnabled;
+                    CARD64 stats_start = 0, stats_out = 0;
+                    unsigned long stats_resets = ReqStatsResets;
+                    int stats_index = client->index;
+                    int stats_major = client->majorOp;
+                    int stats_minor = client->minorOp;
+                    CARD32 stats_in = result;
+
+                    if (stats) {
+                        stats_out = client->reqStats.bytes_out;
+                        stats_start = GetTimeInMicros();
+                    }
+
                     result = XaceHookDispatch(client, client->majorOp);
                     if (result == Success)
                         result =
                             (*client->requestVector[client->majorOp]) (client);
                     XaceHookAuditEnd(client, result);
+
+                    /* Nothing to charge a request that reset the stats */
+                    if (stats && stats_resets == ReqStatsResets) {
+                        /* KillClient may have freed the client */
+                        ClientPtr who = clients[stats_index] == client ?
+                            client : NULL;
+
+                        ReqStatsAccount(who, stats_major, stats_minor,
+                                        stats_in,
+                                        who ? who->reqStats.bytes_out -
+                                        stats_out : 0,
+                                        GetTimeInMicros() - stats_start);
+                    }
                 }
 #ifdef XSERVER_DTRACE
                 if (XSERVER_REQUEST_DONE_ENABLED())
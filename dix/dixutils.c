@@ -689,40 +689,48 @@ static CallbackListPtr **listsToCleanup = NULL;
 static Bool
 _AddCallback(CallbackListPtr *pcbl, CallbackProcPtr callback, void *data)
 {
+    CallbackListPtr cbl = *pcbl;
     CallbackPtr cbr;
 
-    cbr = malloc(sizeof(CallbackRec));
-    if (!cbr)
-        return FALSE;
+    if (cbl->numCallbacks == cbl->size) {
+        int size = cbl->size ? cbl->size * 2 : 4;
+
+        cbr = reallocarray(cbl->callbacks, size, sizeof(CallbackRec));
+        if (!cbr)
+            return FALSE;
+        cbl->callbacks = cbr;
+        cbl->size = size;
+    }
+    cbr = &cbl->callbacks[cbl->numCallbacks++];
     cbr->proc = callback;
     cbr->data = data;
-    cbr->next = (*pcbl)->list;
     cbr->deleted = FALSE;
-    (*pcbl)->list = cbr;
     return TRUE;
 }
 
+static void
+_DeleteCallbackList(CallbackListPtr *pcbl);
+
 static Bool
 _DeleteCallback(CallbackListPtr *pcbl, CallbackProcPtr callback, void *data)
 {
     CallbackListPtr cbl = *pcbl;
-    CallbackPtr cbr, pcbr;
+    int i;
 
-    for (pcbr = NULL, cbr = cbl->list; cbr != NULL; pcbr = cbr, cbr = cbr->next) {
-        if ((cbr->proc == callback) && (cbr->data == data))
-            break;
-    }
-    if (cbr != NULL) {
+    for (i = cbl->numCallbacks - 1; i >= 0; i--) {
+        CallbackPtr cbr = &cbl->callbacks[i];
+
+        if (cbr->proc != callback || cbr->data != data || cbr->deleted)
+            continue;
         if (cbl->inCallback) {
             ++(cbl->numDeleted);
             cbr->deleted = TRUE;
         }
         else {
-            if (pcbr == NULL)
-                cbl->list = cbr->next;
-            else
-                pcbr->next = cbr->next;
-            free(cbr);
+            memmove(cbr, cbr + 1,
+                    (--cbl->numCallbacks - i) * sizeof(CallbackRec));
+            if (!cbl->numCallbacks)
+                _DeleteCallbackList(pcbl);
         }
         return TRUE;
     }
@@ -733,11 +741,16 @@ void
 _CallCallbacks(CallbackListPtr *pcbl, void *call_data)
 {
     CallbackListPtr cbl = *pcbl;
-    CallbackPtr cbr, pcbr;
+    int i, j;
 
+    /* Callbacks added from a callback are not called this time around,
+     * and the array may move under us as they are. */
     ++(cbl->inCallback);
-    for (cbr = cbl->list; cbr != NULL; cbr = cbr->next) {
-        (*(cbr->proc)) (pcbl, cbr->data, call_data);
+    for (i = cbl->numCallbacks - 1; i >= 0; i--) {
+        CallbackPtr cbr = &cbl->callbacks[i];
+
+        if (!cbr->deleted)
+            (*(cbr->proc)) (pcbl, cbr->data, call_data);
     }
     --(cbl->inCallback);
 
@@ -756,26 +769,13 @@ _CallCallbacks(CallbackListPtr *pcbl, void *call_data)
      */
 
     if (cbl->numDeleted) {
-        for (pcbr = NULL, cbr = cbl->list; (cbr != NULL) && cbl->numDeleted;) {
-            if (cbr->deleted) {
-                if (pcbr) {
-                    cbr = cbr->next;
-                    free(pcbr->next);
-                    pcbr->next = cbr;
-                }
-                else {
-                    cbr = cbr->next;
-                    free(cbl->list);
-                    cbl->list = cbr;
-                }
-                cbl->numDeleted--;
-            }
-            else {              /* this one wasn't deleted */
-
-                pcbr = cbr;
-                cbr = cbr->next;
-            }
-        }
+        for (i = j = 0; i < cbl->numCallbacks; i++)
+            if (!cbl->callbacks[i].deleted)
+                cbl->callbacks[j++] = cbl->callbacks[i];
+        cbl->numCallbacks = j;
+        cbl->numDeleted = 0;
+        if (!cbl->numCallbacks)
+            DeleteCallbackList(pcbl);
     }
 }
 
@@ -783,7 +783,6 @@ static void
 _DeleteCallbackList(CallbackListPtr *pcbl)
 {
     CallbackListPtr cbl = *pcbl;
-    CallbackPtr cbr, nextcbr;
     int i;
 
     if (cbl->inCallback) {
@@ -798,10 +797,7 @@ _DeleteCallbackList(CallbackListPtr *pcbl)
         }
     }
 
-    for (cbr = cbl->list; cbr != NULL; cbr = nextcbr) {
-        nextcbr = cbr->next;
-        free(cbr);
-    }
+    free(cbl->callbacks);
     free(cbl);
     *pcbl = NULL;
 }
@@ -820,7 +816,9 @@ CreateCallbackList(CallbackListPtr *pcbl)
     cbl->inCallback = 0;
     cbl->deleted = FALSE;
     cbl->numDeleted = 0;
-    cbl->list = NULL;
+    cbl->numCallbacks = 0;
+    cbl->size = 0;
+    cbl->callbacks = NULL;
     *pcbl = cbl;
 
     for (i = 0; i < numCallbackListsToCleanup; i++) {
@@ -850,7 +848,12 @@ AddCallback(CallbackListPtr *pcbl, CallbackProcPtr callback, void *data)
         if (!CreateCallbackList(pcbl))
             return FALSE;
     }
-    return _AddCallback(pcbl, callback, data);
+    if (!_AddCallback(pcbl, callback, data)) {
+        if (!(*pcbl)->numCallbacks)
+            _DeleteCallbackList(pcbl);
+        return FALSE;
+    }
+    return TRUE;
 }
 
 Bool
@@ -33,6 +33,7 @@
 #endif
 
 #include <stdint.h>
+#include <string.h>
 #include <X11/X.h>
 #include <X11/extensions/XIproto.h>
 #include <X11/extensions/XI2proto.h>
@@ -88,6 +89,52 @@ EventIsKeyRepeat(xEvent *event)
     return ! !event->u.u.sequenceNumber;
 }
 
+/**
+ * Wire events built for delivery are borrowed from a few scratch buffers
+ * instead of being allocated for every event.  Delivering one event can
+ * convert and deliver another, so each borrowed event keeps its buffer
+ * until it is released; once all buffers are in use, or a buffer cannot
+ * grow, conversion falls back to the heap.  The buffers only grow, to the
+ * largest event seen, so motion events quickly stop allocating at all.
+ */
+#define WIRE_SCRATCH_BUFFERS 4
+#define WIRE_SCRATCH_MIN_SIZE 256
+
+static struct {
+    void *data;
+    size_t size;
+    Bool busy;
+} wireScratch[WIRE_SCRATCH_BUFFERS];
+
+static Bool wireBorrowing;      /* set while BorrowWireEvent converts */
+
+/* Zeroed storage for a converted event, as calloc */
+static void *
+eventAlloc(size_t len)
+{
+    int i;
+
+    if (!wireBorrowing)
+        return calloc(1, len);
+
+    for (i = 0; i < WIRE_SCRATCH_BUFFERS; i++) {
+        if (wireScratch[i].busy)
+            continue;
+        if (wireScratch[i].size < len) {
+            size_t size = max(len, WIRE_SCRATCH_MIN_SIZE);
+            void *data = realloc(wireScratch[i].data, size);
+
+            if (!data)
+                break;
+            wireScratch[i].data = data;
+            wireScratch[i].size = size;
+        }
+        wireScratch[i].busy = TRUE;
+        return memset(wireScratch[i].data, 0, len);
+    }
+    return calloc(1, len);
+}
+
 /**
  * Convert the given event to the respective core event.
  *
@@ -132,7 +179,7 @@ EventToCore(InternalEvent *event, xEvent **core_out, int *count_out)
             goto out;
         }
 
-        core = calloc(1, sizeof(*core));
+        core = eventAlloc(sizeof(*core));
         if (!core)
             return BadAlloc;
         count = 1;
@@ -293,6 +340,64 @@ EventToXI2(InternalEvent *ev, xEvent **xi)
     return BadImplementation;
 }
 
+/**
+ * Convert the given event to the protocol event for level, like
+ * EventToCore, EventToXI or EventToXI2.  The result is borrowed from
+ * scratch storage: it must be handed back with ReleaseWireEvent rather
+ * than freed, and must not be kept past that.
+ *
+ * @param[in] ev The event to convert.
+ * @param[in] level The protocol level to convert to.
+ * @param[out] xi The converted event, or NULL if there is none.
+ * @param[out] count Number of elements in xi.
+ *
+ * @return Success or the error code.
+ */
+int
+BorrowWireEvent(InternalEvent *ev, enum InputLevel level, xEvent **xi,
+                int *count)
+{
+    int rc;
+
+    *xi = NULL;
+    *count = 0;
+    wireBorrowing = TRUE;
+    switch (level) {
+    case XI2:
+        rc = EventToXI2(ev, xi);
+        *count = 1;
+        break;
+    case XI:
+        rc = EventToXI(ev, xi, count);
+        break;
+    case CORE:
+        rc = EventToCore(ev, xi, count);
+        break;
+    default:
+        rc = BadImplementation;
+        break;
+    }
+    wireBorrowing = FALSE;
+    return rc;
+}
+
+/**
+ * Hand back an event returned by BorrowWireEvent.
+ */
+void
+ReleaseWireEvent(xEvent *xi)
+{
+    int i;
+
+    for (i = 0; i < WIRE_SCRATCH_BUFFERS; i++) {
+        if (wireScratch[i].busy && wireScratch[i].data == xi) {
+            wireScratch[i].busy = FALSE;
+            return;
+        }
+    }
+    free(xi);
+}
+
 static int
 eventToKeyButtonPointer(DeviceEvent *ev, xEvent **xi, int *count)
 {
@@ -328,7 +433,7 @@ eventToKeyButtonPointer(DeviceEvent *ev, xEvent **xi, int *count)
 
     num_events++;               /* the actual event event */
 
-    *xi = calloc(num_events, sizeof(xEvent));
+    *xi = eventAlloc(num_events * sizeof(xEvent));
     if (!(*xi)) {
         return BadAlloc;
     }
@@ -391,7 +496,12 @@ countValuators(DeviceEvent *ev, int *first)
     int first_valuator = -1, last_valuator = -1, num_valuators = 0;
     int i;
 
+    /* Most events set a few low axes, so skip empty bytes whole */
     for (i = 0; i < sizeof(ev->valuators.mask) * 8; i++) {
+        if (!(i & 7) && !ev->valuators.mask[i >> 3]) {
+            i += 7;
+            continue;
+        }
         if (BitIsOn(ev->valuators.mask, i)) {
             if (first_valuator == -1)
                 first_valuator = i;
@@ -575,7 +685,7 @@ eventToDeviceChanged(DeviceChangedEvent *dce, xEvent **xi)
         len += sizeof(CARD32) * nkeys;  /* keycodes */
     }
 
-    dcce = calloc(1, len);
+    dcce = eventAlloc(len);
     if (!dcce) {
         ErrorF("[Xi] BadAlloc in SendDeviceChangedEvent.\n");
         return BadAlloc;
@@ -631,11 +741,8 @@ count_bits(unsigned char *ptr, int len)
     unsigned char x;
 
     for (i = 0; i < len; i++) {
-        x = ptr[i];
-        while (x > 0) {
-            bits += (x & 0x1);
-            x >>= 1;
-        }
+        for (x = ptr[i]; x; x &= x - 1)
+            bits++;
     }
     return bits;
 }
@@ -662,7 +769,7 @@ eventToDeviceEvent(DeviceEvent *ev, xEvent **xi)
     vallen = bytes_to_int32(bits_to_bytes(MAX_VALUATORS));
     len += vallen * 4;          /* valuators mask */
 
-    *xi = calloc(1, len);
+    *xi = eventAlloc(len);
     xde = (xXIDeviceEvent *) * xi;
     xde->type = GenericEvent;
     xde->extension = IReqCode;
@@ -705,11 +812,9 @@ eventToDeviceEvent(DeviceEvent *ev, xEvent **xi)
     xde->group.locked_group = ev->group.locked;
     xde->group.effective_group = ev->group.effective;
 
+    /* The wire button mask has the same layout as the internal one */
     ptr = (char *) &xde[1];
-    for (i = 0; i < sizeof(ev->buttons) * 8; i++) {
-        if (BitIsOn(ev->buttons, i))
-            SetBit(ptr, i);
-    }
+    memcpy(ptr, ev->buttons, sizeof(ev->buttons));
 
     ptr += xde->buttons_len * 4;
     axisval = (FP3232 *) (ptr + xde->valuators_len * 4);
@@ -730,7 +835,7 @@ eventToTouchOwnershipEvent(TouchOwnershipEvent *ev, xEvent **xi)
     int len = sizeof(xXITouchOwnershipEvent);
     xXITouchOwnershipEvent *xtoe;
 
-    *xi = calloc(1, len);
+    *xi = eventAlloc(len);
     xtoe = (xXITouchOwnershipEvent *) * xi;
     xtoe->type = GenericEvent;
     xtoe->extension = IReqCode;
@@ -760,7 +865,7 @@ eventToRawEvent(RawDeviceEvent *ev, xEvent **xi)
     vallen = bytes_to_int32(bits_to_bytes(MAX_VALUATORS));
     len += vallen * 4;          /* valuators mask */
 
-    *xi = calloc(1, len);
+    *xi = eventAlloc(len);
     raw = (xXIRawEvent *) * xi;
     raw->type = GenericEvent;
     raw->extension = IReqCode;
@@ -795,7 +900,7 @@ eventToBarrierEvent(BarrierEvent *ev, xEvent **xi)
     xXIBarrierEvent *barrier;
     int len = sizeof(xXIBarrierEvent);
 
-    *xi = calloc(1, len);
+    *xi = eventAlloc(len);
     barrier = (xXIBarrierEvent*) *xi;
     barrier->type = GenericEvent;
     barrier->extension = IReqCode;
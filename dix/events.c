@@ -2134,8 +2134,57 @@ GetClientsForDelivery(DeviceIntPtr dev, WindowPtr win,
 }
 
 /**
- * Try delivery on each client in inputclients, provided the event mask
- * accepts it and there is no interfering core grab..
+ * Try delivery to one client, provided the event mask accepts it and there
+ * is no interfering core grab.  rc and have_device_button_grab_class_client
+ * carry the outcome across all clients tried for one event.
+ */
+static void
+DeliverEventToInputClient(DeviceIntPtr dev, InputClients * inputclient,
+                          WindowPtr win, xEvent *events,
+                          int count, Mask filter, GrabPtr grab,
+                          enum EventDeliveryState *rc,
+                          Bool *have_device_button_grab_class_client,
+                          ClientPtr *client_return, Mask *mask_return)
+{
+    int attempt;
+    Mask mask;
+    ClientPtr client = rClient(inputclient);
+
+    if (IsInterferingGrab(client, dev, events))
+        return;
+
+    if (IsWrongPointerBarrierClient(client, dev, events))
+        return;
+
+    mask = GetEventMask(dev, events, inputclient);
+
+    if (XaceHook(XACE_RECEIVE_ACCESS, client, win, events, count))
+        /* do nothing */ ;
+    else if ((attempt = TryClientEvents(client, dev,
+                                        events, count,
+                                        mask, filter, grab))) {
+        if (attempt > 0) {
+            /*
+             * The order of clients is arbitrary therefore if one
+             * client belongs to DeviceButtonGrabClass make sure to
+             * catch it.
+             */
+            if (!*have_device_button_grab_class_client) {
+                *rc = EVENT_DELIVERED;
+                *client_return = client;
+                *mask_return = mask;
+                /* Success overrides non-success, so if we've been
+                 * successful on one client, return that */
+                if (mask & DeviceButtonGrabMask)
+                    *have_device_button_grab_class_client = TRUE;
+            }
+        } else if (*rc == EVENT_NOT_DELIVERED)
+            *rc = EVENT_REJECTED;
+    }
+}
+
+/**
+ * Try delivery on each client in inputclients.
  */
 static enum EventDeliveryState
 DeliverEventToInputClients(DeviceIntPtr dev, InputClients * inputclients,
@@ -2143,44 +2192,105 @@ DeliverEventToInputClients(DeviceIntPtr dev, InputClients * inputclients,
                            int count, Mask filter, GrabPtr grab,
                            ClientPtr *client_return, Mask *mask_return)
 {
-    int attempt;
     enum EventDeliveryState rc = EVENT_NOT_DELIVERED;
     Bool have_device_button_grab_class_client = FALSE;
 
-    for (; inputclients; inputclients = inputclients->next) {
-        Mask mask;
-        ClientPtr client = rClient(inputclients);
+    for (; inputclients; inputclients = inputclients->next)
+        DeliverEventToInputClient(dev, inputclients, win, events, count,
+                                  filter, grab, &rc,
+                                  &have_device_button_grab_class_client,
+                                  client_return, mask_return);
 
-        if (IsInterferingGrab(client, dev, events))
-            continue;
+    return rc;
+}
+
+/**
+ * Per-window index of the core event selections of clients other than
+ * the window owner.  The clients selecting for mask bit b are
+ * clients[start[b]] up to clients[start[b + 1] - 1], so delivery only
+ * looks at the clients that selected for the event.
+ */
+#define EVENT_INTEREST_BITS 25  /* KeyPressMask to OwnerGrabButtonMask */
+
+typedef struct _EventInterest {
+    unsigned int start[EVENT_INTEREST_BITS + 1];
+} EventInterestRec, *EventInterestPtr;
+
+#define EventInterestClients(ei) ((OtherClientsPtr *) &(ei)[1])
+
+/**
+ * Rebuild the event interest index and otherEventMasks of the window
+ * after its list of other clients or one of their masks changed.  If the
+ * index can't be allocated, delivery falls back to walking the list.
+ */
+static void
+UpdateEventInterest(WindowPtr pWin)
+{
+    EventInterestPtr interest;
+    OtherClientsPtr other, *clients;
+    Mask mask = 0;
+    int bit, n = 0;
+
+    if (!pWin->optional)
+        return;
+
+    free(pWin->optional->eventInterest);
+    pWin->optional->eventInterest = NULL;
 
-        if (IsWrongPointerBarrierClient(client, dev, events))
+    for (other = wOtherClients(pWin); other; other = other->next) {
+        mask |= other->mask;
+        n += Ones(other->mask);
+    }
+    pWin->optional->otherEventMasks = mask;
+    if (!n)
+        return;
+
+    interest = malloc(sizeof(EventInterestRec) + n * sizeof(OtherClientsPtr));
+    if (!interest)
+        return;
+    clients = EventInterestClients(interest);
+    n = 0;
+    for (bit = 0; bit < EVENT_INTEREST_BITS; bit++) {
+        interest->start[bit] = n;
+        if (!(mask & (1 << bit)))
             continue;
+        for (other = wOtherClients(pWin); other; other = other->next)
+            if (other->mask & (1 << bit))
+                clients[n++] = other;
+    }
+    interest->start[EVENT_INTEREST_BITS] = n;
+    pWin->optional->eventInterest = interest;
+}
 
-        mask = GetEventMask(dev, events, inputclients);
-
-        if (XaceHook(XACE_RECEIVE_ACCESS, client, win, events, count))
-            /* do nothing */ ;
-        else if ((attempt = TryClientEvents(client, dev,
-                                            events, count,
-                                            mask, filter, grab))) {
-            if (attempt > 0) {
-                /*
-                 * The order of clients is arbitrary therefore if one
-                 * client belongs to DeviceButtonGrabClass make sure to
-                 * catch it.
-                 */
-                if (!have_device_button_grab_class_client) {
-                    rc = EVENT_DELIVERED;
-                    *client_return = client;
-                    *mask_return = mask;
-                    /* Success overrides non-success, so if we've been
-                     * successful on one client, return that */
-                    if (mask & DeviceButtonGrabMask)
-                        have_device_button_grab_class_client = TRUE;
-                }
-            } else if (rc == EVENT_NOT_DELIVERED)
-                rc = EVENT_REJECTED;
+/**
+ * Try delivery of a core event on each other client that selected for
+ * any bit of filter.  A client selecting for several of those bits is
+ * only tried under the lowest one.
+ */
+static enum EventDeliveryState
+DeliverEventToInterestedClients(DeviceIntPtr dev, EventInterestPtr interest,
+                                WindowPtr win, xEvent *events,
+                                int count, Mask filter, GrabPtr grab,
+                                ClientPtr *client_return, Mask *mask_return)
+{
+    enum EventDeliveryState rc = EVENT_NOT_DELIVERED;
+    Bool have_device_button_grab_class_client = FALSE;
+    OtherClientsPtr *clients = EventInterestClients(interest);
+    Mask bits = filter & AllEventMasks;
+
+    while (bits) {
+        int bit = ffs(bits) - 1;
+        Mask seen = filter & ((1 << bit) - 1);
+        unsigned int i;
+
+        bits &= bits - 1;
+        for (i = interest->start[bit]; i < interest->start[bit + 1]; i++) {
+            if (clients[i]->mask & seen)
+                continue;
+            DeliverEventToInputClient(dev, (InputClients *) clients[i], win,
+                                      events, count, filter, grab, &rc,
+                                      &have_device_button_grab_class_client,
+                                      client_return, mask_return);
         }
     }
 
@@ -2200,6 +2310,12 @@ DeliverEventToWindowMask(DeviceIntPtr dev, WindowPtr win, xEvent *events,
                          ClientPtr *client_return, Mask *mask_return)
 {
     InputClients *iclients;
+    EventInterestPtr interest;
+
+    if (core_get_type(events) != 0 && (interest = wEventInterest(win)))
+        return DeliverEventToInterestedClients(dev, interest, win, events,
+                                               count, filter, grab,
+                                               client_return, mask_return);
 
     if (!GetClientsForDelivery(dev, win, events, filter, &iclients))
         return EVENT_SKIP;
@@ -2349,10 +2465,10 @@ DeliverRawEvent(RawDeviceEvent *ev, DeviceIntPtr device)
 {
     GrabPtr grab = device->deviceGrab.grab;
     xEvent *xi;
-    int i, rc;
+    int i, rc, count;
     int filter;
 
-    rc = EventToXI2((InternalEvent *) ev, (xEvent **) &xi);
+    rc = BorrowWireEvent((InternalEvent *) ev, XI2, &xi, &count);
     if (rc != Success) {
         ErrorF("[Xi] %s: XI2 conversion failed in %s (%d)\n",
                __func__, device->name, rc);
@@ -2391,7 +2507,7 @@ DeliverRawEvent(RawDeviceEvent *ev, DeviceIntPtr device)
         }
     }
 
-    free(xi);
+    ReleaseWireEvent(xi);
 }
 
 /* If the event goes to dontClient, don't send it and return 0.  if
@@ -2429,6 +2545,7 @@ MaybeDeliverEventsToClient(WindowPtr pWin, xEvent *pEvents,
                            int count, Mask filter, ClientPtr dontClient)
 {
     OtherClients *other;
+    EventInterestPtr interest;
 
     if (pWin->eventMask & filter) {
         if (wClient(pWin) == dontClient)
@@ -2443,23 +2560,30 @@ MaybeDeliverEventsToClient(WindowPtr pWin, xEvent *pEvents,
         return TryClientEvents(wClient(pWin), NULL, pEvents, count,
                                pWin->eventMask, filter, NullGrab);
     }
-    for (other = wOtherClients(pWin); other; other = other->next) {
-        if (other->mask & filter) {
-            if (SameClient(other, dontClient))
-                return 0;
+    if (!(wOtherEventMasks(pWin) & filter))
+        return 2;
+    if ((interest = wEventInterest(pWin))) {
+        /* The first client selecting for the lowest bit is as good as any */
+        int bit = ffs(wOtherEventMasks(pWin) & filter) - 1;
+
+        other = EventInterestClients(interest)[interest->start[bit]];
+    }
+    else {
+        for (other = wOtherClients(pWin); other; other = other->next)
+            if (other->mask & filter)
+                break;
+    }
+    if (SameClient(other, dontClient))
+        return 0;
 #ifdef PANORAMIX
-            if (!noPanoramiXExtension && pWin->drawable.pScreen->myNum)
-                return XineramaTryClientEventsResult(rClient(other), NullGrab,
-                                                     other->mask, filter);
+    if (!noPanoramiXExtension && pWin->drawable.pScreen->myNum)
+        return XineramaTryClientEventsResult(rClient(other), NullGrab,
+                                             other->mask, filter);
 #endif
-            if (XaceHook(XACE_RECEIVE_ACCESS, rClient(other), pWin, pEvents,
-                         count))
-                return 1;       /* don't send, but pretend we did */
-            return TryClientEvents(rClient(other), NULL, pEvents, count,
-                                   other->mask, filter, NullGrab);
-        }
-    }
-    return 2;
+    if (XaceHook(XACE_RECEIVE_ACCESS, rClient(other), pWin, pEvents, count))
+        return 1;               /* don't send, but pretend we did */
+    return TryClientEvents(rClient(other), NULL, pEvents, count,
+                           other->mask, filter, NullGrab);
 }
 
 static Window
@@ -2655,25 +2779,10 @@ DeliverOneEvent(InternalEvent *event, DeviceIntPtr dev, enum InputLevel level,
     int deliveries = 0;
     int rc;
 
-    switch (level) {
-    case XI2:
-        rc = EventToXI2(event, &xE);
-        count = 1;
-        break;
-    case XI:
-        rc = EventToXI(event, &xE, &count);
-        break;
-    case CORE:
-        rc = EventToCore(event, &xE, &count);
-        break;
-    default:
-        rc = BadImplementation;
-        break;
-    }
-
+    rc = BorrowWireEvent(event, level, &xE, &count);
     if (rc == Success) {
         deliveries = DeliverEvent(dev, xE, count, win, child, grab);
-        free(xE);
+        ReleaseWireEvent(xE);
     }
     else
         BUG_WARN_MSG(rc != BadMatch,
@@ -3671,7 +3780,7 @@ ActivatePassiveGrab(DeviceIntPtr device, GrabPtr grab, InternalEvent *event,
     }
 
     if (grab->grabtype == CORE) {
-        rc = EventToCore(event, &xE, &count);
+        rc = BorrowWireEvent(event, CORE, &xE, &count);
         if (rc != Success) {
             BUG_WARN_MSG(rc != BadMatch, "[dix] %s: core conversion failed"
                          "(%d, %d).\n", device->name, event->any.type, rc);
@@ -3679,17 +3788,16 @@ ActivatePassiveGrab(DeviceIntPtr device, GrabPtr grab, InternalEvent *event,
         }
     }
     else if (grab->grabtype == XI2) {
-        rc = EventToXI2(event, &xE);
+        rc = BorrowWireEvent(event, XI2, &xE, &count);
         if (rc != Success) {
             if (rc != BadMatch)
                 BUG_WARN_MSG(rc != BadMatch, "[dix] %s: XI2 conversion failed"
                              "(%d, %d).\n", device->name, event->any.type, rc);
             return FALSE;
         }
-        count = 1;
     }
     else {
-        rc = EventToXI(event, &xE, &count);
+        rc = BorrowWireEvent(event, XI, &xE, &count);
         if (rc != Success) {
             if (rc != BadMatch)
                 BUG_WARN_MSG(rc != BadMatch, "[dix] %s: XI conversion failed"
@@ -3714,7 +3822,7 @@ ActivatePassiveGrab(DeviceIntPtr device, GrabPtr grab, InternalEvent *event,
         grabinfo->sync.state = FROZEN_WITH_EVENT;
     *grabinfo->sync.event = real_event->device_event;
 
-    free(xE);
+    ReleaseWireEvent(xE);
     return TRUE;
 }
 
@@ -3909,10 +4017,11 @@ CheckPassiveGrabsOnWindow(WindowPtr pWin,
                           DeviceIntPtr device,
                           InternalEvent *event, BOOL checkCore, BOOL activate)
 {
-    GrabPtr grab = wPassiveGrabs(pWin);
+    GrabPtr grab;
     GrabPtr tempGrab;
+    PassiveGrabIterRec iter;
 
-    if (!grab)
+    if (!wPassiveGrabs(pWin))
         return NULL;
 
     tempGrab = AllocGrab(NULL);
@@ -3942,7 +4051,8 @@ CheckPassiveGrabsOnWindow(WindowPtr pWin,
     tempGrab->modifiersDetail.pMask = NULL;
     tempGrab->next = NULL;
 
-    for (; grab; grab = grab->next) {
+    for (grab = FirstPassiveGrab(pWin, tempGrab->detail.exact, &iter); grab;
+         grab = NextPassiveGrab(&iter)) {
         if (!CheckPassiveGrab(device, grab, event, checkCore, tempGrab))
             continue;
 
@@ -4078,7 +4188,7 @@ DeliverFocusedEvent(DeviceIntPtr keybd, InternalEvent *event, WindowPtr window)
     /* just deliver it to the focus window */
     ptr = GetMaster(keybd, POINTER_OR_FLOAT);
 
-    rc = EventToXI2(event, &xi2);
+    rc = BorrowWireEvent(event, XI2, &xi2, &count);
     if (rc == Success) {
         /* XXX: XACE */
         int filter = GetEventFilter(keybd, xi2);
@@ -4094,7 +4204,7 @@ DeliverFocusedEvent(DeviceIntPtr keybd, InternalEvent *event, WindowPtr window)
             ("[dix] %s: XI2 conversion failed in DFE (%d, %d). Skipping delivery.\n",
              keybd->name, event->any.type, rc);
 
-    rc = EventToXI(event, &xE, &count);
+    rc = BorrowWireEvent(event, XI, &xE, &count);
     if (rc == Success &&
         XaceHook(XACE_SEND_ACCESS, NULL, keybd, focus, xE, count) == Success) {
         FixUpEventFromWindow(ptr->spriteInfo->sprite, xE, focus, None, FALSE);
@@ -4110,7 +4220,7 @@ DeliverFocusedEvent(DeviceIntPtr keybd, InternalEvent *event, WindowPtr window)
              keybd->name, event->any.type, rc);
 
     if (sendCore) {
-        rc = EventToCore(event, &core, &count);
+        rc = BorrowWireEvent(event, CORE, &core, &count);
         if (rc == Success) {
             if (XaceHook(XACE_SEND_ACCESS, NULL, keybd, focus, core, count) ==
                 Success) {
@@ -4129,9 +4239,9 @@ DeliverFocusedEvent(DeviceIntPtr keybd, InternalEvent *event, WindowPtr window)
     }
 
  unwind:
-    free(core);
-    free(xE);
-    free(xi2);
+    ReleaseWireEvent(core);
+    ReleaseWireEvent(xE);
+    ReleaseWireEvent(xi2);
     return;
 }
 
@@ -4154,8 +4264,7 @@ DeliverOneGrabbedEvent(InternalEvent *event, DeviceIntPtr dev,
 
     switch (level) {
     case XI2:
-        rc = EventToXI2(event, &xE);
-        count = 1;
+        rc = BorrowWireEvent(event, XI2, &xE, &count);
         if (rc == Success) {
             int evtype = xi2_get_type(xE);
 
@@ -4168,12 +4277,12 @@ DeliverOneGrabbedEvent(InternalEvent *event, DeviceIntPtr dev,
             mask = grab->deviceMask;
         else
             mask = grab->eventMask;
-        rc = EventToXI(event, &xE, &count);
+        rc = BorrowWireEvent(event, XI, &xE, &count);
         if (rc == Success)
             filter = GetEventFilter(dev, xE);
         break;
     case CORE:
-        rc = EventToCore(event, &xE, &count);
+        rc = BorrowWireEvent(event, CORE, &xE, &count);
         mask = grab->eventMask;
         if (rc == Success)
             filter = GetEventFilter(dev, xE);
@@ -4200,7 +4309,7 @@ DeliverOneGrabbedEvent(InternalEvent *event, DeviceIntPtr dev,
                      "%s: conversion to mode %d failed on %d with %d\n",
                      dev->name, level, event->any.type, rc);
 
-    free(xE);
+    ReleaseWireEvent(xE);
     return deliveries;
 }
 
@@ -4325,33 +4434,31 @@ FixKeyState(DeviceEvent *event, DeviceIntPtr keybd)
  * delivered to a window.
  *
  * The otherEventMasks on a WindowOptional is the combination of all event
- * masks set by all clients on the window.
+ * masks set by all clients on the window, kept up to date along with the
+ * event interest index.
  * deliverableEventMask is the combination of the eventMask and the
  * otherEventMask plus the events that may be propagated to the parent.
  *
- * Traverses to siblings and parents of the window.
+ * Traverses the subtree of the window, skipping the children of windows
+ * whose deliverable events did not change.
  */
 void
 RecalculateDeliverableEvents(WindowPtr pWin)
 {
-    OtherClients *others;
     WindowPtr pChild;
+    Mask old;
 
     pChild = pWin;
     while (1) {
-        if (pChild->optional) {
-            pChild->optional->otherEventMasks = 0;
-            for (others = wOtherClients(pChild); others; others = others->next) {
-                pChild->optional->otherEventMasks |= others->mask;
-            }
-        }
+        old = pChild->deliverableEvents;
         pChild->deliverableEvents = pChild->eventMask |
             wOtherEventMasks(pChild);
         if (pChild->parent)
             pChild->deliverableEvents |=
                 (pChild->parent->deliverableEvents &
                  ~wDontPropagateMask(pChild) & PropagateMask);
-        if (pChild->firstChild) {
+        /* Children only depend on us through deliverableEvents */
+        if (pChild->firstChild && pChild->deliverableEvents != old) {
             pChild = pChild->firstChild;
             continue;
         }
@@ -4379,10 +4486,12 @@ OtherClientGone(void *value, XID id)
             if (prev)
                 prev->next = other->next;
             else {
-                if (!(pWin->optional->otherClients = other->next))
-                    CheckWindowOptionalNeed(pWin);
+                pWin->optional->otherClients = other->next;
             }
             free(other);
+            UpdateEventInterest(pWin);
+            if (!pWin->optional->otherClients)
+                CheckWindowOptionalNeed(pWin);
             RecalculateDeliverableEvents(pWin);
             return Success;
         }
@@ -4436,6 +4545,7 @@ EventSelectForWindow(WindowPtr pWin, ClientPtr client, Mask mask)
                 }
                 else
                     others->mask = mask;
+                UpdateEventInterest(pWin);
                 goto maskSet;
             }
         }
@@ -4451,6 +4561,7 @@ EventSelectForWindow(WindowPtr pWin, ClientPtr client, Mask mask)
         pWin->optional->otherClients = others;
         if (!AddResource(others->resource, RT_OTHERCLIENT, (void *) pWin))
             return BadAlloc;
+        UpdateEventInterest(pWin);
     }
  maskSet:
     if ((mask & PointerMotionHintMask) && !(check & PointerMotionHintMask)) {
@@ -74,6 +74,9 @@ static unsigned char DefaultDash[2] = { 4, 4 };
 void
 ValidateGC(DrawablePtr pDraw, GC * pGC)
 {
+    /* Nothing to do if neither the GC nor the drawable changed since */
+    if (!pGC->stateChanges && pGC->serialNumber == pDraw->serialNumber)
+        return;
     (*pGC->funcs->ValidateGC) (pGC, pGC->stateChanges, pDraw);
     pGC->stateChanges = 0;
     pGC->serialNumber = pDraw->serialNumber;
@@ -119,6 +122,14 @@ ValidateGC(DrawablePtr pDraw, GC * pGC)
 #define NEXT_PTR(_type, _var) { \
     _var = (_type)pUnion->ptr; pUnion++; }
 
+/* Store a value, dropping its change bit if it is the same as before */
+#define SETVAL(_field, _val) do { \
+	if ((_field) == (_val)) \
+	    index2 = 0; \
+	else \
+	    (_field) = (_val); \
+    } while (0)
+
 int
 ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
 {
@@ -128,13 +139,11 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
     BITS32 maskQ;
 
     assert(pUnion);
-    pGC->serialNumber |= GC_CHANGE_SERIAL_BIT;
 
     maskQ = mask;               /* save these for when we walk the GCque */
     while (mask && !error) {
         index2 = (BITS32) lowbit(mask);
         mask &= ~index2;
-        pGC->stateChanges |= index2;
         switch (index2) {
         case GCFunction:
         {
@@ -142,7 +151,7 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             NEXTVAL(CARD8, newalu);
 
             if (newalu <= GXset)
-                pGC->alu = newalu;
+                SETVAL(pGC->alu, newalu);
             else {
                 if (client)
                     client->errorValue = newalu;
@@ -151,12 +160,19 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             break;
         }
         case GCPlaneMask:
-            NEXTVAL(unsigned long, pGC->planemask);
+        {
+            unsigned long newplanemask;
+            NEXTVAL(unsigned long, newplanemask);
 
+            SETVAL(pGC->planemask, newplanemask);
             break;
+        }
         case GCForeground:
-            NEXTVAL(unsigned long, pGC->fgPixel);
+        {
+            unsigned long newfg;
+            NEXTVAL(unsigned long, newfg);
 
+            SETVAL(pGC->fgPixel, newfg);
             /*
              * this is for CreateGC
              */
@@ -165,21 +181,30 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
                 pGC->tile.pixel = pGC->fgPixel;
             }
             break;
+        }
         case GCBackground:
-            NEXTVAL(unsigned long, pGC->bgPixel);
+        {
+            unsigned long newbg;
+            NEXTVAL(unsigned long, newbg);
 
+            SETVAL(pGC->bgPixel, newbg);
             break;
+        }
         case GCLineWidth:      /* ??? line width is a CARD16 */
-            NEXTVAL(CARD16, pGC->lineWidth);
+        {
+            CARD16 newwidth;
+            NEXTVAL(CARD16, newwidth);
 
+            SETVAL(pGC->lineWidth, newwidth);
             break;
+        }
         case GCLineStyle:
         {
             unsigned int newlinestyle;
             NEXTVAL(unsigned int, newlinestyle);
 
             if (newlinestyle <= LineDoubleDash)
-                pGC->lineStyle = newlinestyle;
+                SETVAL(pGC->lineStyle, newlinestyle);
             else {
                 if (client)
                     client->errorValue = newlinestyle;
@@ -193,7 +218,7 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             NEXTVAL(unsigned int, newcapstyle);
 
             if (newcapstyle <= CapProjecting)
-                pGC->capStyle = newcapstyle;
+                SETVAL(pGC->capStyle, newcapstyle);
             else {
                 if (client)
                     client->errorValue = newcapstyle;
@@ -207,7 +232,7 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             NEXTVAL(unsigned int, newjoinstyle);
 
             if (newjoinstyle <= JoinBevel)
-                pGC->joinStyle = newjoinstyle;
+                SETVAL(pGC->joinStyle, newjoinstyle);
             else {
                 if (client)
                     client->errorValue = newjoinstyle;
@@ -221,7 +246,7 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             NEXTVAL(unsigned int, newfillstyle);
 
             if (newfillstyle <= FillOpaqueStippled)
-                pGC->fillStyle = newfillstyle;
+                SETVAL(pGC->fillStyle, newfillstyle);
             else {
                 if (client)
                     client->errorValue = newfillstyle;
@@ -235,7 +260,7 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             NEXTVAL(unsigned int, newfillrule);
 
             if (newfillrule <= WindingRule)
-                pGC->fillRule = newfillrule;
+                SETVAL(pGC->fillRule, newfillrule);
             else {
                 if (client)
                     client->errorValue = newfillrule;
@@ -275,13 +300,21 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             }
             break;
         case GCTileStipXOrigin:
-            NEXTVAL(INT16, pGC->patOrg.x);
+        {
+            INT16 newx;
+            NEXTVAL(INT16, newx);
 
+            SETVAL(pGC->patOrg.x, newx);
             break;
+        }
         case GCTileStipYOrigin:
-            NEXTVAL(INT16, pGC->patOrg.y);
+        {
+            INT16 newy;
+            NEXTVAL(INT16, newy);
 
+            SETVAL(pGC->patOrg.y, newy);
             break;
+        }
         case GCFont:
         {
             FontPtr pFont;
@@ -299,7 +332,7 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             NEXTVAL(unsigned int, newclipmode);
 
             if (newclipmode <= IncludeInferiors)
-                pGC->subWindowMode = newclipmode;
+                SETVAL(pGC->subWindowMode, newclipmode);
             else {
                 if (client)
                     client->errorValue = newclipmode;
@@ -313,7 +346,7 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             NEXTVAL(unsigned int, newge);
 
             if (newge <= xTrue)
-                pGC->graphicsExposures = newge;
+                SETVAL(pGC->graphicsExposures, newge);
             else {
                 if (client)
                     client->errorValue = newge;
@@ -322,13 +355,21 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             break;
         }
         case GCClipXOrigin:
-            NEXTVAL(INT16, pGC->clipOrg.x);
+        {
+            INT16 newx;
+            NEXTVAL(INT16, newx);
 
+            SETVAL(pGC->clipOrg.x, newx);
             break;
+        }
         case GCClipYOrigin:
-            NEXTVAL(INT16, pGC->clipOrg.y);
+        {
+            INT16 newy;
+            NEXTVAL(INT16, newy);
 
+            SETVAL(pGC->clipOrg.y, newy);
             break;
+        }
         case GCClipMask:
             NEXT_PTR(PixmapPtr, pPixmap);
 
@@ -344,9 +385,13 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
                                        (void *) pPixmap, 0);
             break;
         case GCDashOffset:
-            NEXTVAL(INT16, pGC->dashOffset);
+        {
+            INT16 newoffset;
+            NEXTVAL(INT16, newoffset);
 
+            SETVAL(pGC->dashOffset, newoffset);
             break;
+        }
         case GCDashList:
         {
             CARD8 newdash;
@@ -387,7 +432,7 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             NEXTVAL(unsigned int, newarcmode);
 
             if (newarcmode <= ArcPieSlice)
-                pGC->arcMode = newarcmode;
+                SETVAL(pGC->arcMode, newarcmode);
             else {
                 if (client)
                     client->errorValue = newarcmode;
@@ -401,6 +446,8 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             error = BadValue;
             break;
         }
+        /* Only values which actually changed need revalidating */
+        pGC->stateChanges |= index2;
     }                           /* end while mask && !error */
 
     if (pGC->fillStyle == FillTiled && pGC->tileIsPixel) {
@@ -409,12 +456,15 @@ ChangeGC(ClientPtr client, GC * pGC, BITS32 mask, ChangeGCValPtr pUnion)
             error = BadAlloc;
         }
     }
+    if (pGC->stateChanges)
+        pGC->serialNumber |= GC_CHANGE_SERIAL_BIT;
     (*pGC->funcs->ChangeGC) (pGC, maskQ);
     return error;
 }
 
 #undef NEXTVAL
 #undef NEXT_PTR
+#undef SETVAL
 
 static const struct {
     BITS32 mask;
@@ -780,7 +830,7 @@ FreeGC(void *value, XID gid)
     (*pGC->funcs->DestroyGC) (pGC);
     if (pGC->dash != DefaultDash)
         free(pGC->dash);
-    dixFreeObjectWithPrivates(pGC, PRIVATE_GC);
+    dixFreeScreenObjectWithPrivates(pGC->pScreen, pGC, PRIVATE_GC);
     return Success;
 }
 
@@ -207,46 +207,70 @@ init_raw(DeviceIntPtr dev, RawDeviceEvent *event, Time ms, int type, int detail)
     event->detail.button = detail;
 }
 
-static void
-set_raw_valuators(RawDeviceEvent *event, ValuatorMask *mask,
-                  BOOL use_unaccel, double *data)
+/**
+ * Store the numbers of the axes set in mask into axes, in ascending order,
+ * and return how many there are. The valuator passes below walk these
+ * rather than testing every bit up to the size of the mask.
+ */
+static int
+compact_valuators(const ValuatorMask *mask, int *axes)
 {
-    int i;
+    int i, n = 0;
 
-    use_unaccel = use_unaccel && valuator_mask_has_unaccelerated(mask);
+    for (i = 0; i <= mask->last_bit; i += 8) {
+        int bits = mask->mask[i / 8];
 
-    for (i = 0; i < valuator_mask_size(mask); i++) {
-        if (valuator_mask_isset(mask, i)) {
-            double v;
+        while (bits) {
+            int axis = i + ffs(bits) - 1;
 
-            SetBit(event->valuators.mask, i);
+            if (axis > mask->last_bit)
+                break;
+            axes[n++] = axis;
+            bits &= bits - 1;
+        }
+    }
+    return n;
+}
 
-            if (use_unaccel)
-                v = valuator_mask_get_unaccelerated(mask, i);
-            else
-                v = valuator_mask_get_double(mask, i);
+static void
+set_raw_valuators(RawDeviceEvent *event, ValuatorMask *mask,
+                  BOOL use_unaccel, double *data)
+{
+    const double *values;
+    int axes[MAX_VALUATORS];
+    int i, n;
 
-            data[i] = v;
-        }
+    use_unaccel = use_unaccel && mask->has_unaccelerated;
+    values = use_unaccel ? mask->unaccelerated : mask->valuators;
+
+    n = compact_valuators(mask, axes);
+    for (i = 0; i < n; i++) {
+        SetBit(event->valuators.mask, axes[i]);
+        data[axes[i]] = values[axes[i]];
     }
 }
 
 static void
 set_valuators(DeviceIntPtr dev, DeviceEvent *event, ValuatorMask *mask)
 {
-    int i;
+    AxisInfoPtr ax = dev->valuator->axes;
+    int axes[MAX_VALUATORS];
+    int i, n;
 
     /* Set the data to the previous value for unset absolute axes. The values
      * may be used when sent as part of an XI 1.x valuator event. */
-    for (i = 0; i < valuator_mask_size(mask); i++) {
-        if (valuator_mask_isset(mask, i)) {
-            SetBit(event->valuators.mask, i);
-            if (valuator_get_mode(dev, i) == Absolute)
-                SetBit(event->valuators.mode, i);
-            event->valuators.data[i] = valuator_mask_get_double(mask, i);
-        }
-        else
-            event->valuators.data[i] = dev->valuator->axisVal[i];
+    memcpy(event->valuators.data, dev->valuator->axisVal,
+           min(valuator_mask_size(mask), dev->valuator->numAxes) *
+           sizeof(double));
+
+    n = compact_valuators(mask, axes);
+    for (i = 0; i < n; i++) {
+        int axis = axes[i];
+
+        SetBit(event->valuators.mask, axis);
+        if ((ax[axis].mode & DeviceMode) == Absolute)
+            SetBit(event->valuators.mode, axis);
+        event->valuators.data[axis] = mask->valuators[axis];
     }
 }
 
@@ -683,15 +707,12 @@ clipAxis(DeviceIntPtr pDev, int axisNum, double *val)
 static void
 clipValuators(DeviceIntPtr pDev, ValuatorMask *mask)
 {
-    int i;
-
-    for (i = 0; i < valuator_mask_size(mask); i++)
-        if (valuator_mask_isset(mask, i)) {
-            double val = valuator_mask_get_double(mask, i);
+    int axes[MAX_VALUATORS];
+    int i, n;
 
-            clipAxis(pDev, i, &val);
-            valuator_mask_set_double(mask, i, val);
-        }
+    n = compact_valuators(mask, axes);
+    for (i = 0; i < n; i++)
+        clipAxis(pDev, axes[i], &mask->valuators[axes[i]]);
 }
 
 /**
@@ -740,17 +761,7 @@ UpdateFromMaster(InternalEvent *events, DeviceIntPtr dev, int type,
 static void
 clipAbsolute(DeviceIntPtr dev, ValuatorMask *mask)
 {
-    int i;
-
-    for (i = 0; i < valuator_mask_size(mask); i++) {
-        double val;
-
-        if (!valuator_mask_isset(mask, i))
-            continue;
-        val = valuator_mask_get_double(mask, i);
-        clipAxis(dev, i, &val);
-        valuator_mask_set_double(mask, i, val);
-    }
+    clipValuators(dev, mask);
 }
 
 static void
@@ -758,8 +769,9 @@ add_to_scroll_valuator(DeviceIntPtr dev, ValuatorMask *mask, int valuator, doubl
 {
     double v;
 
-    if (!valuator_mask_fetch_double(mask, valuator, &v))
+    if (!valuator_mask_isset(mask, valuator))
         return;
+    v = mask->valuators[valuator];
 
     /* protect against scrolling overflow. INT_MAX for double, because
      * we'll eventually write this as 32.32 fixed point */
@@ -772,7 +784,7 @@ add_to_scroll_valuator(DeviceIntPtr dev, ValuatorMask *mask, int valuator, doubl
     else
         v += value;
 
-    valuator_mask_set_double(mask, valuator, v);
+    mask->valuators[valuator] = v;
 }
 
 
@@ -808,7 +820,8 @@ scale_for_device_resolution(DeviceIntPtr dev, ValuatorMask *mask)
 static void
 moveRelative(DeviceIntPtr dev, int flags, ValuatorMask *mask)
 {
-    int i;
+    int axes[MAX_VALUATORS];
+    int i, n;
     Bool clip_xy = IsMaster(dev) || !IsFloating(dev);
     ValuatorClassPtr v = dev->valuator;
 
@@ -821,22 +834,17 @@ moveRelative(DeviceIntPtr dev, int flags, ValuatorMask *mask)
     }
 
     /* calc other axes, clip, drop back into valuators */
-    for (i = 0; i < valuator_mask_size(mask); i++) {
-        double val = dev->last.valuators[i];
+    n = compact_valuators(mask, axes);
+    for (i = 0; i < n; i++) {
+        int axis = axes[i];
 
-        if (!valuator_mask_isset(mask, i))
-            continue;
-
-        add_to_scroll_valuator(dev, mask, i, val);
+        add_to_scroll_valuator(dev, mask, axis, dev->last.valuators[axis]);
 
         /* x & y need to go over the limits to cross screens if the SD
          * isn't currently attached; otherwise, clip to screen bounds. */
-        if (valuator_get_mode(dev, i) == Absolute &&
-            ((i != 0 && i != 1) || clip_xy)) {
-            val = valuator_mask_get_double(mask, i);
-            clipAxis(dev, i, &val);
-            valuator_mask_set_double(mask, i, val);
-        }
+        if ((v->axes[axis].mode & DeviceMode) == Absolute &&
+            ((axis != 0 && axis != 1) || clip_xy))
+            clipAxis(dev, axis, &mask->valuators[axis]);
     }
 }
 
@@ -1177,16 +1185,21 @@ FreeEventList(InternalEvent *list, int num_events)
 
 /**
  * Transform vector x/y according to matrix m and drop the rounded coords
- * back into x/y.
+ * back into x/y. This is pixman_f_transform_point(), kept inline: like it,
+ * leave x/y alone if the point ends up at infinity.
  */
-static void
-transform(struct pixman_f_transform *m, double *x, double *y)
+static inline void
+transform(const struct pixman_f_transform *m, double *x, double *y)
 {
-    struct pixman_f_vector p = {.v = {*x, *y, 1} };
-    pixman_f_transform_point(m, &p);
+    double tx = m->m[0][0] * *x + m->m[0][1] * *y + m->m[0][2];
+    double ty = m->m[1][0] * *x + m->m[1][1] * *y + m->m[1][2];
+    double w = m->m[2][0] * *x + m->m[2][1] * *y + m->m[2][2];
+
+    if (!w)
+        return;
 
-    *x = p.v[0];
-    *y = p.v[1];
+    *x = tx / w;
+    *y = ty / w;
 }
 
 static void
@@ -1231,31 +1244,32 @@ transformAbsolute(DeviceIntPtr dev, ValuatorMask *mask)
         return;
 
     if (!has_x || !has_y) {
-        struct pixman_f_transform invert;
-
         /* undo transformation from last event */
         ox = dev->last.valuators[0];
         oy = dev->last.valuators[1];
 
-        pixman_f_transform_invert(&invert, &dev->scale_and_transform);
-        transform(&invert, &ox, &oy);
+        transform(&dev->scale_and_transform_inverse, &ox, &oy);
     }
 
     if (has_x)
-        ox = valuator_mask_get_double(mask, 0);
+        ox = mask->valuators[0];
 
     if (has_y)
-        oy = valuator_mask_get_double(mask, 1);
+        oy = mask->valuators[1];
 
     x = ox;
     y = oy;
 
     transform(&dev->scale_and_transform, &x, &y);
 
-    if (has_x || ox != x)
+    if (has_x)
+        mask->valuators[0] = x;
+    else if (ox != x)
         valuator_mask_set_double(mask, 0, x);
 
-    if (has_y || oy != y)
+    if (has_y)
+        mask->valuators[1] = y;
+    else if (oy != y)
         valuator_mask_set_double(mask, 1, y);
 }
 
@@ -1263,22 +1277,21 @@ static void
 storeLastValuators(DeviceIntPtr dev, ValuatorMask *mask,
                    int xaxis, int yaxis, double devx, double devy)
 {
-    int i;
+    int axes[MAX_VALUATORS];
+    int i, n;
 
     /* store desktop-wide in last.valuators */
-    if (valuator_mask_isset(mask, xaxis))
-        dev->last.valuators[0] = devx;
-    if (valuator_mask_isset(mask, yaxis))
-        dev->last.valuators[1] = devy;
-
-    for (i = 0; i < valuator_mask_size(mask); i++) {
-        if (i == xaxis || i == yaxis)
-            continue;
-
-        if (valuator_mask_isset(mask, i))
-            dev->last.valuators[i] = valuator_mask_get_double(mask, i);
+    n = compact_valuators(mask, axes);
+    for (i = 0; i < n; i++) {
+        int axis = axes[i];
+
+        if (axis == xaxis)
+            dev->last.valuators[0] = devx;
+        else if (axis == yaxis)
+            dev->last.valuators[1] = devy;
+        else
+            dev->last.valuators[axis] = mask->valuators[axis];
     }
-
 }
 
 /**
@@ -1625,7 +1638,8 @@ GetPointerEvents(InternalEvent *events, DeviceIntPtr pDev, int type,
     int num_events = 0, nev_tmp;
     ValuatorMask mask;
     ValuatorMask scroll;
-    int i;
+    int axes[MAX_VALUATORS];
+    int i, n;
     int realtype = type;
 
 #if XSERVER_DTRACE
@@ -1710,17 +1724,20 @@ GetPointerEvents(InternalEvent *events, DeviceIntPtr pDev, int type,
 
     /* Now turn the smooth-scrolling axes back into emulated button presses
      * for legacy clients, based on the integer delta between before and now */
-    for (i = 0; i < valuator_mask_size(&mask); i++) {
-        if ( !pDev->valuator || (i >= pDev->valuator->numAxes))
+    n = compact_valuators(&mask, axes);
+    for (i = 0; i < n; i++) {
+        int axis = axes[i];
+
+        if ( !pDev->valuator || (axis >= pDev->valuator->numAxes))
             break;
 
-        if (!valuator_mask_isset(&mask, i))
+        if (pDev->valuator->axes[axis].scroll.type == SCROLL_TYPE_NONE)
             continue;
 
-        valuator_mask_set_double(&scroll, i, pDev->last.valuators[i]);
+        valuator_mask_set_double(&scroll, axis, pDev->last.valuators[axis]);
 
         nev_tmp =
-            emulate_scroll_button_events(events, pDev, realtype, i, &scroll,
+            emulate_scroll_button_events(events, pDev, realtype, axis, &scroll,
                                          pDev->last.scroll, ms,
                                          GetMaximumEventsNum() - num_events);
         events += nev_tmp;
@@ -1894,6 +1911,8 @@ GetTouchEvents(InternalEvent *events, DeviceIntPtr dev, uint32_t ddx_touchid,
     int num_events = 0;
     RawDeviceEvent *raw;
     DDXTouchPointInfoPtr ti;
+    int axes[MAX_VALUATORS];
+    int n;
     int need_rawevent = TRUE;
     Bool emulate_pointer = FALSE;
     int client_id = 0;
@@ -1974,15 +1993,18 @@ GetTouchEvents(InternalEvent *events, DeviceIntPtr dev, uint32_t ddx_touchid,
      * these come from the touchpoint in Absolute mode, or the sprite in
      * Relative. */
     if (t->mode == XIDirectTouch) {
-        for (i = 0; i < max(valuator_mask_size(&mask), 2); i++) {
+        n = compact_valuators(&mask, axes);
+        for (i = 0; i < n; i++)
+            valuator_mask_set_double(ti->valuators, axes[i],
+                                     mask.valuators[axes[i]]);
+
+        /* If the device doesn't post new X and Y axis values,
+         * use the last values posted.
+         */
+        for (i = 0; i < 2; i++) {
             double val;
 
-            if (valuator_mask_fetch_double(&mask, i, &val))
-                valuator_mask_set_double(ti->valuators, i, val);
-            /* If the device doesn't post new X and Y axis values,
-             * use the last values posted.
-             */
-            else if (i < 2 &&
+            if (!valuator_mask_isset(&mask, i) &&
                 valuator_mask_fetch_double(ti->valuators, i, &val))
                 valuator_mask_set_double(&mask, i, val);
         }
@@ -2036,10 +2058,9 @@ GetTouchEvents(InternalEvent *events, DeviceIntPtr dev, uint32_t ddx_touchid,
     }
 
     set_valuators(dev, event, &mask);
-    for (i = 0; i < v->numAxes; i++) {
-        if (valuator_mask_isset(&mask, i))
-            v->axisVal[i] = valuator_mask_get(&mask, i);
-    }
+    n = compact_valuators(&mask, axes);
+    for (i = 0; i < n && axes[i] < v->numAxes; i++)
+        v->axisVal[axes[i]] = trunc(mask.valuators[axes[i]]);
 
     return num_events;
 }
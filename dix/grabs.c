@@ -315,6 +315,187 @@ CopyGrab(GrabPtr dst, const GrabPtr src)
     return TRUE;
 }
 
+/*
+ * Windows carrying many passive grabs, such as a root window holding every
+ * global key binding, get an index of their grabs by detail.  For an event
+ * with a detail other than AnyKey, the only grabs that can match are those
+ * on that same detail and those on AnyKey (see GrabMatchesSecond), so only
+ * those are tried.  Both sets remember each grab's position in the list
+ * and are walked merged, so the first matching grab is still the one
+ * nearest the head of the list.  Changes to the list mark the index stale
+ * and it is rebuilt by the next lookup.
+ */
+
+#define GRAB_INDEX_MIN 8
+
+typedef struct _GrabIndexEntry {
+    GrabPtr grab;
+    unsigned int pos;           /* position in the window's list */
+    unsigned int key;           /* 0 for AnyKey, else bucket + 1 */
+} GrabIndexEntryRec, *GrabIndexEntryPtr;
+
+typedef struct _GrabIndex {
+    Bool stale;                 /* the list changed since it was indexed */
+    unsigned int bits;          /* log2 of the number of buckets */
+    unsigned int *start;        /* bucket b is entries[start[b]..start[b+1]) */
+    GrabIndexEntryPtr entries;  /* AnyKey grabs first, then by bucket */
+} GrabIndexRec, *GrabIndexPtr;
+
+static inline unsigned int
+GrabIndexHash(unsigned int detail, unsigned int bits)
+{
+    return ((CARD32) detail * 0x9E3779B1U) >> (32 - bits);
+}
+
+static int
+CompareGrabIndexEntries(const void *a, const void *b)
+{
+    const GrabIndexEntryRec *ea = a, *eb = b;
+
+    if (ea->key != eb->key)
+        return ea->key < eb->key ? -1 : 1;
+    return ea->pos < eb->pos ? -1 : ea->pos > eb->pos;
+}
+
+static void
+FreeGrabIndex(WindowPtr pWin)
+{
+    GrabIndexPtr index = pWin->optional->grabIndex;
+
+    if (!index)
+        return;
+    free(index->start);
+    free(index->entries);
+    free(index);
+    pWin->optional->grabIndex = NULL;
+}
+
+static void
+InvalidateGrabIndex(WindowPtr pWin)
+{
+    if (pWin->optional && pWin->optional->grabIndex)
+        pWin->optional->grabIndex->stale = TRUE;
+}
+
+static Bool
+BuildGrabIndex(GrabIndexPtr index, GrabPtr list, unsigned int count)
+{
+    GrabIndexEntryPtr entries;
+    unsigned int *start;
+    unsigned int bits, b, i;
+    GrabPtr grab;
+
+    for (bits = 4; bits < 16 && (1U << bits) < count; bits++);
+    start = xallocarray((1 << bits) + 1, sizeof(unsigned int));
+    entries = xallocarray(count, sizeof(GrabIndexEntryRec));
+    if (!start || !entries) {
+        free(start);
+        free(entries);
+        return FALSE;
+    }
+
+    for (grab = list, i = 0; grab; grab = grab->next, i++) {
+        entries[i].grab = grab;
+        entries[i].pos = i;
+        entries[i].key = grab->detail.exact == AnyKey ? 0 :
+            GrabIndexHash(grab->detail.exact, bits) + 1;
+    }
+    qsort(entries, count, sizeof(GrabIndexEntryRec), CompareGrabIndexEntries);
+
+    for (b = 0, i = 0; b <= (1 << bits); b++) {
+        while (i < count && entries[i].key <= b)
+            i++;
+        start[b] = i;
+    }
+
+    free(index->start);
+    free(index->entries);
+    index->start = start;
+    index->entries = entries;
+    index->bits = bits;
+    index->stale = FALSE;
+    return TRUE;
+}
+
+/* Return the up to date index for the window, or NULL to walk the list */
+static GrabIndexPtr
+PassiveGrabIndex(WindowPtr pWin, GrabPtr list)
+{
+    GrabIndexPtr index = pWin->optional->grabIndex;
+    unsigned int count = 0;
+    GrabPtr grab;
+
+    if (index && !index->stale)
+        return index;
+
+    for (grab = list; grab; grab = grab->next)
+        count++;
+    if (count < GRAB_INDEX_MIN)
+        return NULL;
+
+    if (!index) {
+        index = calloc(1, sizeof(GrabIndexRec));
+        if (!index)
+            return NULL;
+        pWin->optional->grabIndex = index;
+    }
+    return BuildGrabIndex(index, list, count) ? index : NULL;
+}
+
+/**
+ * Start walking the passive grabs on pWin that may match an event with the
+ * given detail, in the order they appear in the window's list.  Grabs that
+ * cannot match are skipped when the window's grabs are indexed; callers
+ * must still check every grab returned.
+ *
+ * @return The first candidate grab, or NULL if there is none.
+ */
+GrabPtr
+FirstPassiveGrab(WindowPtr pWin, unsigned int detail, PassiveGrabIterPtr iter)
+{
+    GrabPtr list = wPassiveGrabs(pWin);
+    GrabIndexPtr index;
+
+    iter->next = list;
+    iter->indexed = FALSE;
+    if (list && detail != AnyKey && (index = PassiveGrabIndex(pWin, list))) {
+        unsigned int b = GrabIndexHash(detail, index->bits);
+
+        iter->indexed = TRUE;
+        iter->detail = detail;
+        iter->exact = index->entries + index->start[b];
+        iter->exactEnd = index->entries + index->start[b + 1];
+        iter->any = index->entries;
+        iter->anyEnd = index->entries + index->start[0];
+    }
+    return NextPassiveGrab(iter);
+}
+
+GrabPtr
+NextPassiveGrab(PassiveGrabIterPtr iter)
+{
+    GrabPtr grab;
+
+    if (!iter->indexed) {
+        grab = iter->next;
+        if (grab)
+            iter->next = grab->next;
+        return grab;
+    }
+
+    /* Other details that share the bucket */
+    while (iter->exact < iter->exactEnd &&
+           iter->exact->grab->detail.exact != iter->detail)
+        iter->exact++;
+
+    if (iter->exact < iter->exactEnd &&
+        (iter->any == iter->anyEnd || iter->exact->pos < iter->any->pos))
+        return (iter->exact++)->grab;
+    if (iter->any < iter->anyEnd)
+        return (iter->any++)->grab;
+    return NULL;
+}
+
 int
 DeletePassiveGrab(void *value, XID id)
 {
@@ -327,8 +508,14 @@ DeletePassiveGrab(void *value, XID id)
         if (pGrab == g) {
             if (prev)
                 prev->next = g->next;
-            else if (!(pGrab->window->optional->passiveGrabs = g->next))
+            else
+                pGrab->window->optional->passiveGrabs = g->next;
+            if (pGrab->window->optional->passiveGrabs)
+                InvalidateGrabIndex(pGrab->window);
+            else {
+                FreeGrabIndex(pGrab->window);
                 CheckWindowOptionalNeed(pGrab->window);
+            }
             break;
         }
         prev = g;
@@ -563,6 +750,7 @@ AddPassiveGrabToList(ClientPtr client, GrabPtr pGrab)
 
     pGrab->next = pGrab->window->optional->passiveGrabs;
     pGrab->window->optional->passiveGrabs = pGrab;
+    InvalidateGrabIndex(pGrab->window);
     if (AddResource(pGrab->resource, RT_PASSIVEGRAB, (void *) pGrab))
         return Success;
     return BadAlloc;
@@ -688,6 +876,7 @@ DeletePassiveGrabFromList(GrabPtr pMinuendGrab)
             grab = adds[i];
             grab->next = grab->window->optional->passiveGrabs;
             grab->window->optional->passiveGrabs = grab;
+            InvalidateGrabIndex(grab->window);
         }
         for (i = 0; i < nups; i++) {
             free(*updates[i]);
@@ -689,7 +689,9 @@ CountBits(const uint8_t * mask, int len)
     int i;
     int ret = 0;
 
-    for (i = 0; i < len; i++)
+    for (i = 0; i < len / 8; i++)
+        ret += Ones(mask[i]);
+    for (i *= 8; i < len; i++)
         if (BitIsOn(mask, i))
             ret++;
 
@@ -105,6 +105,7 @@ Equipment Corporation.
 #include "extnsionst.h"
 #include "privates.h"
 #include "registry.h"
+#include "reqstats.h"
 #include "client.h"
 #include "exevents.h"
 #ifdef PANORAMIX
@@ -363,6 +364,8 @@ dix_main(int argc, char *argv[], char *envp[])
 
 	dixFreeRegistry();
 
+        ReqStatsFree();
+
         FreeFonts();
 
         FreeAllAtoms();
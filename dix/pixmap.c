@@ -105,22 +105,36 @@ FreeScratchPixmapsForScreen(ScreenPtr pScreen)
     FreeScratchPixmapHeader(pScreen->pScratchPixmap);
 }
 
+/*
+ * Pixmaps with at most this many bytes of pixel data, which includes
+ * the header-only pixmaps of accelerated drivers, are all allocated at
+ * that size so that they can share the screen's pixmap object cache.
+ */
+#define PIXMAP_CACHE_DATA 64
+
 /* callable by ddx */
 PixmapPtr
 AllocatePixmap(ScreenPtr pScreen, int pixDataSize)
 {
     PixmapPtr pPixmap;
+    Bool cached = pixDataSize <= PIXMAP_CACHE_DATA;
 
     assert(pScreen->totalPixmapSize > 0);
 
     if (pScreen->totalPixmapSize > ((size_t) - 1) - pixDataSize)
         return NullPixmap;
 
-    pPixmap = malloc(pScreen->totalPixmapSize + pixDataSize);
+    if (cached)
+        pPixmap = dixAllocateCachedObject(pScreen, PRIVATE_PIXMAP,
+                                          pScreen->totalPixmapSize +
+                                          PIXMAP_CACHE_DATA);
+    else
+        pPixmap = malloc(pScreen->totalPixmapSize + pixDataSize);
     if (!pPixmap)
         return NullPixmap;
 
     dixInitScreenPrivates(pScreen, pPixmap, pPixmap + 1, PRIVATE_PIXMAP);
+    pPixmap->cached = cached;
     return pPixmap;
 }
 
@@ -128,8 +142,14 @@ AllocatePixmap(ScreenPtr pScreen, int pixDataSize)
 void
 FreePixmap(PixmapPtr pPixmap)
 {
+    ScreenPtr pScreen = pPixmap->drawable.pScreen;
+
     dixFiniPrivates(pPixmap, PRIVATE_PIXMAP);
-    free(pPixmap);
+    if (pPixmap->cached)
+        dixFreeCachedObject(pScreen, PRIVATE_PIXMAP, pPixmap,
+                            pScreen->totalPixmapSize + PIXMAP_CACHE_DATA);
+    else
+        free(pPixmap);
 }
 
 PixmapPtr PixmapShareToSlave(PixmapPtr pixmap, ScreenPtr slave)
@@ -112,6 +112,13 @@ static const char *key_names[PRIVATE_LAST] = {
     [PRIVATE_SYNC_FENCE] = "SYNC_FENCE",
 };
 
+/* Types whose objects are recycled through the per-screen object caches */
+static const Bool cached_object[PRIVATE_LAST] = {
+    [PRIVATE_WINDOW] = TRUE,
+    [PRIVATE_PIXMAP] = TRUE,
+    [PRIVATE_GC] = TRUE,
+};
+
 static const Bool screen_specific_private[PRIVATE_LAST] = {
     [PRIVATE_SCREEN] = FALSE,
     [PRIVATE_CLIENT] = FALSE,
@@ -638,6 +645,133 @@ dixRegisterScreenSpecificPrivateKey(ScreenPtr pScreen, DevPrivateKey key,
     return TRUE;
 }
 
+/*
+ * Objects of the cached types are kept on a free list per screen and
+ * type when they are freed, up to OBJECT_CACHE_MAX of them, and handed
+ * out again most recently freed first while their memory is likely to
+ * be cached.  Private sizes are fixed while objects of a type exist, so
+ * every object in a cache has the same size; when it changes across
+ * server generations the cache is simply emptied.  Caches are closed
+ * along with their screen, as objects freed by CloseScreen would
+ * otherwise be stranded in them.
+ *
+ * The caches live here rather than in the screen's DevPrivateSetRec,
+ * which ScreenRec embeds ahead of the screen procs.  Only protocol
+ * screens have one; GPU screens allocate straight from malloc.
+ */
+#define OBJECT_CACHE_MAX 64
+#define OBJECT_CACHE_CLOSED ((unsigned) -1)
+
+typedef struct _CachedObject {
+    struct _CachedObject *next;
+} CachedObjectRec, *CachedObjectPtr;
+
+typedef struct _ObjectCache {
+    CachedObjectPtr objects;    /* freed objects kept for reuse */
+    unsigned size;              /* size of each of them */
+    int cached;
+    unsigned long generation;   /* server generation the cache is for */
+    unsigned long allocs;       /* objects handed out through the cache */
+    unsigned long reused;       /* ... of which came from it */
+} ObjectCacheRec, *ObjectCachePtr;
+
+static ObjectCacheRec objectCaches[MAXSCREENS][PRIVATE_LAST];
+
+static void
+FlushObjectCache(ObjectCachePtr cache)
+{
+    CachedObjectPtr obj, next;
+
+    for (obj = cache->objects; obj; obj = next) {
+        next = obj->next;
+        free(obj);
+    }
+    cache->objects = NULL;
+    cache->cached = 0;
+}
+
+/* Screens only come and go with server generations, which start over
+ * with an empty cache */
+static ObjectCachePtr
+GetObjectCache(ScreenPtr pScreen, DevPrivateType type)
+{
+    ObjectCachePtr cache;
+
+    if (pScreen->myNum < 0 || pScreen->myNum >= MAXSCREENS)
+        return NULL;
+    cache = &objectCaches[pScreen->myNum][type];
+    if (cache->generation != serverGeneration) {
+        FlushObjectCache(cache);
+        cache->size = 0;
+        cache->allocs = 0;
+        cache->reused = 0;
+        cache->generation = serverGeneration;
+    }
+    return cache;
+}
+
+void *
+dixAllocateCachedObject(ScreenPtr pScreen, DevPrivateType type,
+                        unsigned size)
+{
+    ObjectCachePtr cache = GetObjectCache(pScreen, type);
+    CachedObjectPtr obj;
+
+    assert(cached_object[type]);
+
+    if (!cache)
+        return malloc(size);
+    cache->allocs++;
+    if (cache->size == OBJECT_CACHE_CLOSED)
+        return malloc(size);
+    if (cache->size != size) {
+        FlushObjectCache(cache);
+        cache->size = size;
+    }
+    if (!(obj = cache->objects))
+        return malloc(size);
+    cache->objects = obj->next;
+    cache->cached--;
+    cache->reused++;
+    return obj;
+}
+
+void
+dixFreeCachedObject(ScreenPtr pScreen, DevPrivateType type, void *object,
+                    unsigned size)
+{
+    ObjectCachePtr cache = GetObjectCache(pScreen, type);
+    CachedObjectPtr obj = object;
+
+    assert(cached_object[type]);
+
+    if (!object)
+        return;
+    if (!cache || size != cache->size || cache->cached >= OBJECT_CACHE_MAX) {
+        free(object);
+        return;
+    }
+    obj->next = cache->objects;
+    cache->objects = obj;
+    cache->cached++;
+}
+
+Bool
+dixGetObjectCacheStats(ScreenPtr pScreen, DevPrivateType type,
+                       ObjectCacheStatsPtr stats)
+{
+    ObjectCachePtr cache;
+
+    if (!cached_object[type] || !(cache = GetObjectCache(pScreen, type)))
+        return FALSE;
+    stats->name = key_names[type];
+    stats->cached = cache->cached;
+    stats->size = cache->size;
+    stats->allocs = cache->allocs;
+    stats->reused = cache->reused;
+    return TRUE;
+}
+
 /* Clean up screen-specific privates before CloseScreen */
 void
 dixFreeScreenSpecificPrivates(ScreenPtr pScreen)
@@ -650,6 +784,14 @@ dixFreeScreenSpecificPrivates(ScreenPtr pScreen)
         for (key = pScreen->screenSpecificPrivates[t].key; key; key = key->next) {
             key->initialized = FALSE;
         }
+        if (cached_object[t]) {
+            ObjectCachePtr cache = GetObjectCache(pScreen, t);
+
+            if (cache) {
+                FlushObjectCache(cache);
+                cache->size = OBJECT_CACHE_CLOSED;
+            }
+        }
     }
 }
 
@@ -709,7 +851,10 @@ _dixAllocateScreenObjectWithPrivates(ScreenPtr pScreen,
     /* round up so that pointer is aligned */
     baseSize = (baseSize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
     totalSize = baseSize + privates_size;
-    object = malloc(totalSize);
+    if (pScreen && cached_object[type])
+        object = dixAllocateCachedObject(pScreen, type, totalSize);
+    else
+        object = malloc(totalSize);
     if (!object)
         return NULL;
 
@@ -722,6 +867,28 @@ _dixAllocateScreenObjectWithPrivates(ScreenPtr pScreen,
     return object;
 }
 
+/*
+ * Free an object allocated by dixAllocateScreenObjectWithPrivates,
+ * keeping it for reuse where possible.
+ *
+ * This is expected to be invoked from the
+ * dixFreeScreenObjectWithPrivates macro
+ */
+void
+_dixFreeScreenObjectWithPrivates(ScreenPtr pScreen, void *object,
+                                 unsigned baseSize, PrivatePtr privates,
+                                 DevPrivateType type)
+{
+    _dixFiniPrivates(privates, type);
+    if (pScreen && cached_object[type]) {
+        baseSize = (baseSize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+        dixFreeCachedObject(pScreen, type, object, baseSize +
+                            pScreen->screenSpecificPrivates[type].offset);
+    }
+    else
+        free(object);
+}
+
 int
 dixScreenSpecificPrivatesSize(ScreenPtr pScreen, DevPrivateType type)
 {
@@ -65,8 +65,206 @@ SOFTWARE.
  *   Properties belong to windows.  The list of properties should not be
  *   traversed directly.  Instead, use the three functions listed above.
  *
+ *   Besides the list, each window with properties has an index from
+ *   property name to the first property of that name in the list.
+ *   Windows with few properties keep the names in a small array that is
+ *   searched linearly; past PROPERTY_INLINE names the index becomes an
+ *   open addressing hash table.
+ *
  *****************************************************************/
 
+#define PROPERTY_INLINE 8
+
+typedef struct _PropertyIndexEntry {
+    ATOM name;
+    PropertyPtr prop;
+} PropertyIndexEntryRec, *PropertyIndexEntryPtr;
+
+typedef struct _PropertyIndex {
+    unsigned int count;         /* names in the index */
+    unsigned int bits;          /* log2 of the hash size, 0 while inline */
+    PropertyIndexEntryPtr entries;
+    PropertyIndexEntryRec inline_entries[PROPERTY_INLINE];
+} PropertyIndexRec, *PropertyIndexPtr;
+
+static inline unsigned int
+PropertyHash(ATOM name, unsigned int bits)
+{
+    return ((CARD32) name * 0x9E3779B1U) >> (32 - bits);
+}
+
+/* Return the entry for name, or the free hash slot where it belongs */
+static PropertyIndexEntryPtr
+FindPropertyEntry(PropertyIndexPtr index, ATOM name)
+{
+    PropertyIndexEntryPtr entry;
+    unsigned int i, mask;
+
+    if (!index->bits) {
+        for (i = 0; i < index->count; i++)
+            if (index->entries[i].name == name)
+                return &index->entries[i];
+        return NULL;
+    }
+
+    mask = (1 << index->bits) - 1;
+    i = PropertyHash(name, index->bits);
+    for (;;) {
+        entry = &index->entries[i];
+        if (entry->name == name || entry->name == None)
+            return entry;
+        i = (i + 1) & mask;
+    }
+}
+
+static PropertyPtr
+IndexedProperty(WindowPtr pWin, ATOM name)
+{
+    PropertyIndexEntryPtr entry;
+
+    if (!pWin->optional || !pWin->optional->propIndex)
+        return NULL;
+    entry = FindPropertyEntry(pWin->optional->propIndex, name);
+    return entry && entry->name == name ? entry->prop : NULL;
+}
+
+static Bool
+RehashProperties(PropertyIndexPtr index, unsigned int bits)
+{
+    PropertyIndexEntryPtr old = index->entries;
+    unsigned int i, oldsize = index->bits ? 1 << index->bits : index->count;
+
+    index->entries = calloc(1 << bits, sizeof(PropertyIndexEntryRec));
+    if (!index->entries) {
+        index->entries = old;
+        return FALSE;
+    }
+    index->bits = bits;
+    for (i = 0; i < oldsize; i++)
+        if (old[i].name != None)
+            *FindPropertyEntry(index, old[i].name) = old[i];
+    if (old != index->inline_entries)
+        free(old);
+    return TRUE;
+}
+
+/* Make pProp the property found for its name */
+static Bool
+IndexProperty(WindowPtr pWin, PropertyPtr pProp)
+{
+    PropertyIndexPtr index = pWin->optional->propIndex;
+    PropertyIndexEntryPtr entry;
+
+    if (!index) {
+        index = calloc(1, sizeof(PropertyIndexRec));
+        if (!index)
+            return FALSE;
+        index->entries = index->inline_entries;
+        pWin->optional->propIndex = index;
+    }
+
+    entry = FindPropertyEntry(index, pProp->propertyName);
+    if (entry && entry->name != None) {
+        entry->prop = pProp;
+        return TRUE;
+    }
+
+    if (!index->bits && index->count == PROPERTY_INLINE) {
+        if (!RehashProperties(index, 5))
+            return FALSE;
+        entry = FindPropertyEntry(index, pProp->propertyName);
+    }
+    else if (index->bits && (index->count + 1) * 2 > (1 << index->bits)) {
+        if (!RehashProperties(index, index->bits + 1))
+            return FALSE;
+        entry = FindPropertyEntry(index, pProp->propertyName);
+    }
+    else if (!index->bits)
+        entry = &index->entries[index->count];
+
+    entry->name = pProp->propertyName;
+    entry->prop = pProp;
+    index->count++;
+    return TRUE;
+}
+
+static void
+UnindexProperty(PropertyIndexPtr index, PropertyIndexEntryPtr entry)
+{
+    unsigned int i, j, mask;
+
+    index->count--;
+    if (!index->bits) {
+        *entry = index->entries[index->count];
+        return;
+    }
+
+    /* Shift back later entries of the probe run into the hole */
+    mask = (1 << index->bits) - 1;
+    i = entry - index->entries;
+    for (j = (i + 1) & mask; index->entries[j].name != None;
+         j = (j + 1) & mask) {
+        unsigned int home = PropertyHash(index->entries[j].name, index->bits);
+
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            index->entries[i] = index->entries[j];
+            i = j;
+        }
+    }
+    index->entries[i].name = None;
+}
+
+static void
+FreePropertyIndex(WindowPtr pWin)
+{
+    PropertyIndexPtr index = pWin->optional->propIndex;
+
+    if (!index)
+        return;
+    if (index->entries != index->inline_entries)
+        free(index->entries);
+    free(index);
+    pWin->optional->propIndex = NULL;
+}
+
+/*
+ * Take pProp off the window's property list.  With polyinstantiated
+ * properties a later property of the same name may take its place in
+ * the index.
+ */
+static void
+UnlinkProperty(WindowPtr pWin, PropertyPtr pProp)
+{
+    PropertyIndexEntryPtr entry;
+    PropertyPtr prevProp, other;
+
+    entry = FindPropertyEntry(pWin->optional->propIndex, pProp->propertyName);
+    if (entry->prop == pProp) {
+        for (other = pProp->next; other; other = other->next)
+            if (other->propertyName == pProp->propertyName)
+                break;
+        if (other)
+            entry->prop = other;
+        else
+            UnindexProperty(pWin->optional->propIndex, entry);
+    }
+
+    if (pWin->optional->userProps == pProp) {
+        /* Takes care of head */
+        if (!(pWin->optional->userProps = pProp->next)) {
+            FreePropertyIndex(pWin);
+            CheckWindowOptionalNeed(pWin);
+        }
+    }
+    else {
+        /* Need to traverse to find the previous element */
+        prevProp = pWin->optional->userProps;
+        while (prevProp->next != pProp)
+            prevProp = prevProp->next;
+        prevProp->next = pProp->next;
+    }
+}
+
 #ifdef notdef
 static void
 PrintPropertys(WindowPtr pWin)
@@ -95,10 +293,7 @@ dixLookupProperty(PropertyPtr *result, WindowPtr pWin, Atom propertyName,
 
     client->errorValue = propertyName;
 
-    for (pProp = wUserProps(pWin); pProp; pProp = pProp->next)
-        if (pProp->propertyName == propertyName)
-            break;
-
+    pProp = IndexedProperty(pWin, propertyName);
     if (pProp)
         rc = XaceHookPropertyAccess(client, pWin, &pProp, access_mode);
     *result = pProp;
@@ -180,6 +375,7 @@ ProcRotateProperties(ClientPtr client)
             props[j]->format = saved[i].format;
             props[j]->size = saved[i].size;
             props[j]->data = saved[i].data;
+            props[j]->allocated = saved[i].allocated;
         }
     }
  out:
@@ -248,6 +444,8 @@ dixChangeWindowProperty(ClientPtr pClient, WindowPtr pWin, Atom property,
     PropertyRec savedProp;
     int sizeInBytes, totalSize, rc;
     unsigned char *data;
+    size_t oldSize;
+    Bool inplace;
     Mask access_mode;
 
     sizeInBytes = format >> 3;
@@ -273,9 +471,12 @@ dixChangeWindowProperty(ClientPtr pClient, WindowPtr pWin, Atom property,
         pProp->type = type;
         pProp->format = format;
         pProp->data = data;
+        pProp->allocated = totalSize;
         pProp->size = len;
         rc = XaceHookPropertyAccess(pClient, pWin, &pProp,
                                     DixCreateAccess | DixWriteAccess);
+        if (rc == Success && !IndexProperty(pWin, pProp))
+            rc = BadAlloc;
         if (rc != Success) {
             free(data);
             dixFreeObjectWithPrivates(pProp, PRIVATE_PROPERTY);
@@ -299,12 +500,27 @@ dixChangeWindowProperty(ClientPtr pClient, WindowPtr pWin, Atom property,
         /* save the old values for later */
         savedProp = *pProp;
 
+        /*
+         * The old data must survive until the new content has been
+         * checked, unless nobody checks it.  Appending only writes past
+         * the old data, so it never needs a copy of it.
+         */
+        inplace = !XaceHookIsSet(XACE_PROPERTY_ACCESS);
+        oldSize = pProp->size * sizeInBytes;
+
         if (mode == PropModeReplace) {
-            data = malloc(totalSize);
-            if (!data && len)
-                return BadAlloc;
-            memcpy(data, value, totalSize);
-            pProp->data = data;
+            if (inplace && totalSize <= pProp->allocated &&
+                totalSize >= pProp->allocated / 2) {
+                memmove(pProp->data, value, totalSize);
+            }
+            else {
+                data = malloc(totalSize);
+                if (!data && len)
+                    return BadAlloc;
+                memcpy(data, value, totalSize);
+                pProp->data = data;
+                pProp->allocated = totalSize;
+            }
             pProp->size = len;
             pProp->type = type;
             pProp->format = format;
@@ -312,22 +528,39 @@ dixChangeWindowProperty(ClientPtr pClient, WindowPtr pWin, Atom property,
         else if (len == 0) {
             /* do nothing */
         }
+        else if (pProp->size + len > UINT32_MAX / sizeInBytes) {
+            return BadAlloc;
+        }
         else if (mode == PropModeAppend) {
-            data = xallocarray(pProp->size + len, sizeInBytes);
-            if (!data)
-                return BadAlloc;
-            memcpy(data, pProp->data, pProp->size * sizeInBytes);
-            memcpy(data + pProp->size * sizeInBytes, value, totalSize);
-            pProp->data = data;
+            if (oldSize + totalSize > pProp->allocated) {
+                /* Grow geometrically for repeated appends */
+                size_t allocated = max(oldSize + totalSize,
+                                       pProp->allocated * 2);
+
+                data = malloc(allocated);
+                if (!data)
+                    return BadAlloc;
+                memcpy(data, pProp->data, oldSize);
+                pProp->data = data;
+                pProp->allocated = allocated;
+            }
+            memcpy((char *) pProp->data + oldSize, value, totalSize);
             pProp->size += len;
         }
         else if (mode == PropModePrepend) {
-            data = xallocarray(len + pProp->size, sizeInBytes);
-            if (!data)
-                return BadAlloc;
-            memcpy(data + totalSize, pProp->data, pProp->size * sizeInBytes);
-            memcpy(data, value, totalSize);
-            pProp->data = data;
+            if (inplace && oldSize + totalSize <= pProp->allocated) {
+                memmove((char *) pProp->data + totalSize, pProp->data,
+                        oldSize);
+            }
+            else {
+                data = malloc(oldSize + totalSize);
+                if (!data)
+                    return BadAlloc;
+                memcpy(data + totalSize, pProp->data, oldSize);
+                pProp->data = data;
+                pProp->allocated = oldSize + totalSize;
+            }
+            memcpy(pProp->data, value, totalSize);
             pProp->size += len;
         }
 
@@ -365,7 +598,7 @@ ChangeWindowProperty(WindowPtr pWin, Atom property, Atom type, int format,
 int
 DeleteProperty(ClientPtr client, WindowPtr pWin, Atom propName)
 {
-    PropertyPtr pProp, prevProp;
+    PropertyPtr pProp;
     int rc;
 
     rc = dixLookupProperty(&pProp, pWin, propName, client, DixDestroyAccess);
@@ -373,19 +606,7 @@ DeleteProperty(ClientPtr client, WindowPtr pWin, Atom propName)
         return Success;         /* Succeed if property does not exist */
 
     if (rc == Success) {
-        if (pWin->optional->userProps == pProp) {
-            /* Takes care of head */
-            if (!(pWin->optional->userProps = pProp->next))
-                CheckWindowOptionalNeed(pWin);
-        }
-        else {
-            /* Need to traverse to find the previous element */
-            prevProp = pWin->optional->userProps;
-            while (prevProp->next != pProp)
-                prevProp = prevProp->next;
-            prevProp->next = pProp->next;
-        }
-
+        UnlinkProperty(pWin, pProp);
         deliverPropertyNotifyEvent(pWin, PropertyDelete, pProp->propertyName);
         free(pProp->data);
         dixFreeObjectWithPrivates(pProp, PRIVATE_PROPERTY);
@@ -407,8 +628,10 @@ DeleteAllWindowProperties(WindowPtr pWin)
         pProp = pNextProp;
     }
 
-    if (pWin->optional)
+    if (pWin->optional) {
         pWin->optional->userProps = NULL;
+        FreePropertyIndex(pWin);
+    }
 }
 
 static int
@@ -440,7 +663,7 @@ NullPropertyReply(ClientPtr client, ATOM propertyType, int format)
 int
 ProcGetProperty(ClientPtr client)
 {
-    PropertyPtr pProp, prevProp;
+    PropertyPtr pProp;
     unsigned long n, len, ind;
     int rc;
     WindowPtr pWin;
@@ -526,6 +749,22 @@ ProcGetProperty(ClientPtr client)
         deliverPropertyNotifyEvent(pWin, PropertyDelete, pProp->propertyName);
 
     WriteReplyToClient(client, sizeof(xGenericReply), &reply);
+    if (len && stuff->delete && (reply.bytesAfter == 0)) {
+        /* The data goes away with the property, so rather than being
+           copied out, it is swapped in place and handed to the output
+           layer, which keeps it as long as the client is not reading */
+        char *data = pProp->data;
+        int allocated = min(pProp->allocated, INT_MAX);
+
+        if (client->swapped && reply.format == 32)
+            SwapLongs((CARD32 *) (data + ind), len >> 2);
+        else if (client->swapped && reply.format == 16)
+            SwapShorts((short *) (data + ind), len >> 1);
+        UnlinkProperty(pWin, pProp);
+        dixFreeObjectWithPrivates(pProp, PRIVATE_PROPERTY);
+        WriteOwnedToClient(client, len, data + ind, data, allocated);
+        return Success;
+    }
     if (len) {
         switch (reply.format) {
         case 32:
@@ -543,19 +782,7 @@ ProcGetProperty(ClientPtr client)
 
     if (stuff->delete && (reply.bytesAfter == 0)) {
         /* Delete the Property */
-        if (pWin->optional->userProps == pProp) {
-            /* Takes care of head */
-            if (!(pWin->optional->userProps = pProp->next))
-                CheckWindowOptionalNeed(pWin);
-        }
-        else {
-            /* Need to traverse to find the previous element */
-            prevProp = pWin->optional->userProps;
-            while (prevProp->next != pProp)
-                prevProp = prevProp->next;
-            prevProp->next = pProp->next;
-        }
-
+        UnlinkProperty(pWin, pProp);
         free(pProp->data);
         dixFreeObjectWithPrivates(pProp, PRIVATE_PROPERTY);
     }
@@ -432,6 +432,8 @@ InitTrackers(DeviceVelocityPtr vel, int ntracker)
     free(vel->tracker);
     vel->tracker = (MotionTrackerPtr) calloc(ntracker, sizeof(MotionTracker));
     vel->num_tracker = ntracker;
+    vel->cur_tracker = 0;
+    vel->sum_x = vel->sum_y = 0;
 }
 
 enum directions {
@@ -553,22 +555,37 @@ GetDirection(int dx, int dy)
 #define TRACKER_INDEX(s, d) (((s)->num_tracker + (s)->cur_tracker - (d)) % (s)->num_tracker)
 #define TRACKER(s, d) &(s)->tracker[TRACKER_INDEX(s,d)]
 
+/* the motion accumulated by a tracker */
+#define TRACKER_DX(s, t) ((s)->sum_x - (t)->dx)
+#define TRACKER_DY(s, t) ((s)->sum_y - (t)->dy)
+
+/* rebase the motion sums beyond this, so that they keep their precision */
+#define TRACKER_SUM_LIMIT 65536.0
+
 /**
- * Add the delta motion to each tracker, then reset the latest tracker to
- * 0/0 and set it as the current one.
+ * Add the delta motion to the sum, then start the next tracker from there
+ * and set it as the current one.
  */
 static inline void
 FeedTrackers(DeviceVelocityPtr vel, double dx, double dy, int cur_t)
 {
     int n;
 
-    for (n = 0; n < vel->num_tracker; n++) {
-        vel->tracker[n].dx += dx;
-        vel->tracker[n].dy += dy;
+    vel->sum_x += dx;
+    vel->sum_y += dy;
+    if (fabs(vel->sum_x) > TRACKER_SUM_LIMIT ||
+        fabs(vel->sum_y) > TRACKER_SUM_LIMIT) {
+        for (n = 0; n < vel->num_tracker; n++) {
+            vel->tracker[n].dx -= vel->sum_x;
+            vel->tracker[n].dy -= vel->sum_y;
+        }
+        vel->sum_x = vel->sum_y = 0;
     }
-    n = (vel->cur_tracker + 1) % vel->num_tracker;
-    vel->tracker[n].dx = 0.0;
-    vel->tracker[n].dy = 0.0;
+    n = vel->cur_tracker + 1;
+    if (n == vel->num_tracker)
+        n = 0;
+    vel->tracker[n].dx = vel->sum_x;
+    vel->tracker[n].dy = vel->sum_y;
     vel->tracker[n].time = cur_t;
     vel->tracker[n].dir = GetDirection(dx, dy);
     DebugAccelF("motion [dx: %f dy: %f dir:%d diff: %d]\n",
@@ -583,9 +600,11 @@ FeedTrackers(DeviceVelocityPtr vel, double dx, double dy, int cur_t)
  * This assumes linear motion.
  */
 static double
-CalcTracker(const MotionTracker * tracker, int cur_t)
+CalcTracker(const DeviceVelocityRec * vel, const MotionTracker * tracker,
+            int cur_t)
 {
-    double dist = sqrt(tracker->dx * tracker->dx + tracker->dy * tracker->dy);
+    double dx = TRACKER_DX(vel, tracker), dy = TRACKER_DY(vel, tracker);
+    double dist = sqrt(dx * dx + dy * dy);
     int dtime = cur_t - tracker->time;
 
     if (dtime > 0)
@@ -604,17 +623,22 @@ CalcTracker(const MotionTracker * tracker, int cur_t)
 static double
 QueryTrackers(DeviceVelocityPtr vel, int cur_t)
 {
-    int offset, dir = UNDEFINED, used_offset = -1, age_ms;
+    int offset, index, dir = UNDEFINED, used_offset = -1, age_ms;
 
     /* initial velocity: a low-offset, valid velocity */
     double initial_velocity = 0, result = 0, velocity_diff;
     double velocity_factor = vel->corr_mul * vel->const_acceleration;   /* premultiply */
 
     /* loop from current to older data */
+    index = vel->cur_tracker;
     for (offset = 1; offset < vel->num_tracker; offset++) {
-        MotionTracker *tracker = TRACKER(vel, offset);
+        MotionTracker *tracker;
         double tracker_velocity;
 
+        if (--index < 0)
+            index = vel->num_tracker - 1;
+        tracker = &vel->tracker[index];
+
         age_ms = cur_t - tracker->time;
 
         /* bail out if data is too old and protect from overrun */
@@ -638,7 +662,7 @@ QueryTrackers(DeviceVelocityPtr vel, int cur_t)
             break;
         }
 
-        tracker_velocity = CalcTracker(tracker, cur_t) * velocity_factor;
+        tracker_velocity = CalcTracker(vel, tracker, cur_t) * velocity_factor;
 
         if ((initial_velocity == 0 || offset <= vel->initial_range) &&
             tracker_velocity != 0) {
@@ -674,8 +698,8 @@ QueryTrackers(DeviceVelocityPtr vel, int cur_t)
         MotionTracker *tracker = TRACKER(vel, used_offset);
 
         DebugAccelF("result: offset %i [dx: %f dy: %f diff: %i]\n",
-                    used_offset, tracker->dx, tracker->dy,
-                    cur_t - tracker->time);
+                    used_offset, TRACKER_DX(vel, tracker),
+                    TRACKER_DY(vel, tracker), cur_t - tracker->time);
 #endif
     }
     return result;
@@ -683,6 +707,8 @@ QueryTrackers(DeviceVelocityPtr vel, int cur_t)
 
 #undef TRACKER_INDEX
 #undef TRACKER
+#undef TRACKER_DX
+#undef TRACKER_DY
 
 /**
  * Perform velocity approximation based on 2D 'mickeys' (mouse motion delta).
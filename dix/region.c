@@ -188,19 +188,6 @@ if (!(pReg)->data || (((pReg)->data->numRects + (n)) > (pReg)->data->size)) \
     pNextRect++;				\
 }
 
-#define NEWRECT(pReg,pNextRect,nx1,ny1,nx2,ny2)			\
-{									\
-    if (!(pReg)->data || ((pReg)->data->numRects == (pReg)->data->size))\
-    {									\
-	if (!RegionRectAlloc(pReg, 1))					\
-	    return FALSE;						\
-	pNextRect = RegionTop(pReg);					\
-    }									\
-    ADDRECT(pNextRect,nx1,ny1,nx2,ny2);					\
-    pReg->data->numRects++;						\
-    assert(pReg->data->numRects<=pReg->data->size);			\
-}
-
 #define DOWNSIZE(reg,numRects)						 \
 if (((numRects) < ((reg)->data->size >> 1)) && ((reg)->data->size > 50)) \
 {									 \
@@ -381,7 +368,7 @@ RegionRectAlloc(RegionPtr pRgn, int n)
 }
 
 /*======================================================================
- *	    Generic Region Operator
+ *	    Band Coalescing
  *====================================================================*/
 
 /*-
@@ -389,7 +376,7 @@ RegionRectAlloc(RegionPtr pRgn, int n)
  * RegionCoalesce --
  *	Attempt to merge the boxes in the current band with those in the
  *	previous one.  We are guaranteed that the current band extends to
- *      the end of the rects array.  Used only by RegionOp.
+ *      the end of the rects array.  Used by RegionSweep.
  *
  * Results:
  *	The new index for the previous band.
@@ -470,328 +457,11 @@ RegionCoalesce(RegionPtr pReg,  /* Region to coalesce                */
 	prevBand = curBand;						\
     }
 
-/*-
- *-----------------------------------------------------------------------
- * RegionAppendNonO --
- *	Handle a non-overlapping band for the union and subtract operations.
- *      Just adds the (top/bottom-clipped) rectangles into the region.
- *      Doesn't have to check for subsumption or anything.
- *
- * Results:
- *	None.
- *
- * Side Effects:
- *	pReg->data->numRects is incremented and the rectangles overwritten
- *	with the rectangles we're passed.
- *
- *-----------------------------------------------------------------------
- */
-
-_X_INLINE static Bool
-RegionAppendNonO(RegionPtr pReg, BoxPtr r, BoxPtr rEnd, int y1, int y2)
-{
-    BoxPtr pNextRect;
-    int newRects;
-
-    newRects = rEnd - r;
-
-    assert(y1 < y2);
-    assert(newRects != 0);
-
-    /* Make sure we have enough space for all rectangles to be added */
-    RECTALLOC(pReg, newRects);
-    pNextRect = RegionTop(pReg);
-    pReg->data->numRects += newRects;
-    do {
-        assert(r->x1 < r->x2);
-        ADDRECT(pNextRect, r->x1, y1, r->x2, y2);
-        r++;
-    } while (r != rEnd);
-
-    return TRUE;
-}
-
-#define FindBand(r, rBandEnd, rEnd, ry1)		    \
-{							    \
-    ry1 = r->y1;					    \
-    rBandEnd = r+1;					    \
-    while ((rBandEnd != rEnd) && (rBandEnd->y1 == ry1)) {   \
-	rBandEnd++;					    \
-    }							    \
-}
-
-#define	AppendRegions(newReg, r, rEnd)					\
-{									\
-    int newRects;							\
-    if ((newRects = rEnd - r)) {					\
-	RECTALLOC(newReg, newRects);					\
-	memmove((char *)RegionTop(newReg),(char *)r, 			\
-              newRects * sizeof(BoxRec));				\
-	newReg->data->numRects += newRects;				\
-    }									\
-}
-
-/*-
- *-----------------------------------------------------------------------
- * RegionOp --
- *	Apply an operation to two regions. Called by RegionUnion, RegionInverse,
- *	RegionSubtract, RegionIntersect....  Both regions MUST have at least one
- *      rectangle, and cannot be the same object.
- *
- * Results:
- *	TRUE if successful.
- *
- * Side Effects:
- *	The new region is overwritten.
- *	pOverlap set to TRUE if overlapFunc ever returns TRUE.
- *
- * Notes:
- *	The idea behind this function is to view the two regions as sets.
- *	Together they cover a rectangle of area that this function divides
- *	into horizontal bands where points are covered only by one region
- *	or by both. For the first case, the nonOverlapFunc is called with
- *	each the band and the band's upper and lower extents. For the
- *	second, the overlapFunc is called to process the entire band. It
- *	is responsible for clipping the rectangles in the band, though
- *	this function provides the boundaries.
- *	At the end of each band, the new region is coalesced, if possible,
- *	to reduce the number of rectangles in the region.
- *
- *-----------------------------------------------------------------------
- */
-
-typedef Bool (*OverlapProcPtr) (RegionPtr pReg,
-                                BoxPtr r1,
-                                BoxPtr r1End,
-                                BoxPtr r2,
-                                BoxPtr r2End,
-                                short y1, short y2, Bool *pOverlap);
-
-static Bool
-RegionOp(RegionPtr newReg,      /* Place to store result         */
-         RegionPtr reg1,        /* First region in operation     */
-         RegionPtr reg2,        /* 2d region in operation        */
-         OverlapProcPtr overlapFunc,    /* Function to call for over-
-                                         * lapping bands                 */
-         Bool appendNon1,       /* Append non-overlapping bands  */
-         /* in region 1 ? */
-         Bool appendNon2,       /* Append non-overlapping bands  */
-         /* in region 2 ? */
-         Bool *pOverlap)
-{
-    BoxPtr r1;                  /* Pointer into first region     */
-    BoxPtr r2;                  /* Pointer into 2d region        */
-    BoxPtr r1End;               /* End of 1st region             */
-    BoxPtr r2End;               /* End of 2d region              */
-    short ybot;                 /* Bottom of intersection        */
-    short ytop;                 /* Top of intersection           */
-    RegDataPtr oldData;         /* Old data for newReg           */
-    int prevBand;               /* Index of start of
-                                 * previous band in newReg       */
-    int curBand;                /* Index of start of current
-                                 * band in newReg                */
-    BoxPtr r1BandEnd;           /* End of current band in r1     */
-    BoxPtr r2BandEnd;           /* End of current band in r2     */
-    short top;                  /* Top of non-overlapping band   */
-    short bot;                  /* Bottom of non-overlapping band */
-    int r1y1;                   /* Temps for r1->y1 and r2->y1   */
-    int r2y1;
-    int newSize;
-    int numRects;
-
-    /*
-     * Break any region computed from a broken region
-     */
-    if (RegionNar(reg1) || RegionNar(reg2))
-        return RegionBreak(newReg);
-
-    /*
-     * Initialization:
-     *  set r1, r2, r1End and r2End appropriately, save the rectangles
-     * of the destination region until the end in case it's one of
-     * the two source regions, then mark the "new" region empty, allocating
-     * another array of rectangles for it to use.
-     */
-
-    r1 = RegionRects(reg1);
-    newSize = RegionNumRects(reg1);
-    r1End = r1 + newSize;
-    numRects = RegionNumRects(reg2);
-    r2 = RegionRects(reg2);
-    r2End = r2 + numRects;
-    assert(r1 != r1End);
-    assert(r2 != r2End);
-
-    oldData = NULL;
-    if (((newReg == reg1) && (newSize > 1)) ||
-        ((newReg == reg2) && (numRects > 1))) {
-        oldData = newReg->data;
-        newReg->data = &RegionEmptyData;
-    }
-    /* guess at new size */
-    if (numRects > newSize)
-        newSize = numRects;
-    newSize <<= 1;
-    if (!newReg->data)
-        newReg->data = &RegionEmptyData;
-    else if (newReg->data->size)
-        newReg->data->numRects = 0;
-    if (newSize > newReg->data->size)
-        if (!RegionRectAlloc(newReg, newSize))
-            return FALSE;
-
-    /*
-     * Initialize ybot.
-     * In the upcoming loop, ybot and ytop serve different functions depending
-     * on whether the band being handled is an overlapping or non-overlapping
-     * band.
-     *  In the case of a non-overlapping band (only one of the regions
-     * has points in the band), ybot is the bottom of the most recent
-     * intersection and thus clips the top of the rectangles in that band.
-     * ytop is the top of the next intersection between the two regions and
-     * serves to clip the bottom of the rectangles in the current band.
-     *  For an overlapping band (where the two regions intersect), ytop clips
-     * the top of the rectangles of both regions and ybot clips the bottoms.
-     */
-
-    ybot = min(r1->y1, r2->y1);
-
-    /*
-     * prevBand serves to mark the start of the previous band so rectangles
-     * can be coalesced into larger rectangles. qv. RegionCoalesce, above.
-     * In the beginning, there is no previous band, so prevBand == curBand
-     * (curBand is set later on, of course, but the first band will always
-     * start at index 0). prevBand and curBand must be indices because of
-     * the possible expansion, and resultant moving, of the new region's
-     * array of rectangles.
-     */
-    prevBand = 0;
-
-    do {
-        /*
-         * This algorithm proceeds one source-band (as opposed to a
-         * destination band, which is determined by where the two regions
-         * intersect) at a time. r1BandEnd and r2BandEnd serve to mark the
-         * rectangle after the last one in the current band for their
-         * respective regions.
-         */
-        assert(r1 != r1End);
-        assert(r2 != r2End);
-
-        FindBand(r1, r1BandEnd, r1End, r1y1);
-        FindBand(r2, r2BandEnd, r2End, r2y1);
-
-        /*
-         * First handle the band that doesn't intersect, if any.
-         *
-         * Note that attention is restricted to one band in the
-         * non-intersecting region at once, so if a region has n
-         * bands between the current position and the next place it overlaps
-         * the other, this entire loop will be passed through n times.
-         */
-        if (r1y1 < r2y1) {
-            if (appendNon1) {
-                top = max(r1y1, ybot);
-                bot = min(r1->y2, r2y1);
-                if (top != bot) {
-                    curBand = newReg->data->numRects;
-                    RegionAppendNonO(newReg, r1, r1BandEnd, top, bot);
-                    Coalesce(newReg, prevBand, curBand);
-                }
-            }
-            ytop = r2y1;
-        }
-        else if (r2y1 < r1y1) {
-            if (appendNon2) {
-                top = max(r2y1, ybot);
-                bot = min(r2->y2, r1y1);
-                if (top != bot) {
-                    curBand = newReg->data->numRects;
-                    RegionAppendNonO(newReg, r2, r2BandEnd, top, bot);
-                    Coalesce(newReg, prevBand, curBand);
-                }
-            }
-            ytop = r1y1;
-        }
-        else {
-            ytop = r1y1;
-        }
-
-        /*
-         * Now see if we've hit an intersecting band. The two bands only
-         * intersect if ybot > ytop
-         */
-        ybot = min(r1->y2, r2->y2);
-        if (ybot > ytop) {
-            curBand = newReg->data->numRects;
-            (*overlapFunc) (newReg, r1, r1BandEnd, r2, r2BandEnd, ytop, ybot,
-                            pOverlap);
-            Coalesce(newReg, prevBand, curBand);
-        }
-
-        /*
-         * If we've finished with a band (y2 == ybot) we skip forward
-         * in the region to the next band.
-         */
-        if (r1->y2 == ybot)
-            r1 = r1BandEnd;
-        if (r2->y2 == ybot)
-            r2 = r2BandEnd;
-
-    } while (r1 != r1End && r2 != r2End);
-
-    /*
-     * Deal with whichever region (if any) still has rectangles left.
-     *
-     * We only need to worry about banding and coalescing for the very first
-     * band left.  After that, we can just group all remaining boxes,
-     * regardless of how many bands, into one final append to the list.
-     */
-
-    if ((r1 != r1End) && appendNon1) {
-        /* Do first nonOverlap1Func call, which may be able to coalesce */
-        FindBand(r1, r1BandEnd, r1End, r1y1);
-        curBand = newReg->data->numRects;
-        RegionAppendNonO(newReg, r1, r1BandEnd, max(r1y1, ybot), r1->y2);
-        Coalesce(newReg, prevBand, curBand);
-        /* Just append the rest of the boxes  */
-        AppendRegions(newReg, r1BandEnd, r1End);
-
-    }
-    else if ((r2 != r2End) && appendNon2) {
-        /* Do first nonOverlap2Func call, which may be able to coalesce */
-        FindBand(r2, r2BandEnd, r2End, r2y1);
-        curBand = newReg->data->numRects;
-        RegionAppendNonO(newReg, r2, r2BandEnd, max(r2y1, ybot), r2->y2);
-        Coalesce(newReg, prevBand, curBand);
-        /* Append rest of boxes */
-        AppendRegions(newReg, r2BandEnd, r2End);
-    }
-
-    free(oldData);
-
-    if (!(numRects = newReg->data->numRects)) {
-        xfreeData(newReg);
-        newReg->data = &RegionEmptyData;
-    }
-    else if (numRects == 1) {
-        newReg->extents = *RegionBoxptr(newReg);
-        xfreeData(newReg);
-        newReg->data = NULL;
-    }
-    else {
-        DOWNSIZE(newReg, numRects);
-    }
-
-    return TRUE;
-}
-
 /*-
  *-----------------------------------------------------------------------
  * RegionSetExtents --
  *	Reset the extents of a region to what they should be. Called by
- *	Subtract and Intersect as they can't figure it out along the
- *	way or do so easily, as Union can.
+ *	RegionFromRects for rectangles that are already y-x banded.
  *
  * Results:
  *	None.
@@ -841,106 +511,6 @@ RegionSetExtents(RegionPtr pReg)
     assert(pReg->extents.x1 < pReg->extents.x2);
 }
 
-/*======================================================================
- *	    Region Intersection
- *====================================================================*/
-/*-
- *-----------------------------------------------------------------------
- * RegionIntersectO --
- *	Handle an overlapping band for RegionIntersect.
- *
- * Results:
- *	TRUE if successful.
- *
- * Side Effects:
- *	Rectangles may be added to the region.
- *
- *-----------------------------------------------------------------------
- */
- /*ARGSUSED*/
-#define MERGERECT(r)						\
-{								\
-    if (r->x1 <= x2) {						\
-	/* Merge with current rectangle */			\
-	if (r->x1 < x2) *pOverlap = TRUE;				\
-	if (x2 < r->x2) x2 = r->x2;				\
-    } else {							\
-	/* Add current rectangle, start new one */		\
-	NEWRECT(pReg, pNextRect, x1, y1, x2, y2);		\
-	x1 = r->x1;						\
-	x2 = r->x2;						\
-    }								\
-    r++;							\
-}
-/*======================================================================
- *	    Region Union
- *====================================================================*/
-/*-
- *-----------------------------------------------------------------------
- * RegionUnionO --
- *	Handle an overlapping band for the union operation. Picks the
- *	left-most rectangle each time and merges it into the region.
- *
- * Results:
- *	TRUE if successful.
- *
- * Side Effects:
- *	pReg is overwritten.
- *	pOverlap is set to TRUE if any boxes overlap.
- *
- *-----------------------------------------------------------------------
- */
-    static Bool
-RegionUnionO(RegionPtr pReg,
-             BoxPtr r1,
-             BoxPtr r1End,
-             BoxPtr r2, BoxPtr r2End, short y1, short y2, Bool *pOverlap)
-{
-    BoxPtr pNextRect;
-    int x1;                     /* left and right side of current union */
-    int x2;
-
-    assert(y1 < y2);
-    assert(r1 != r1End && r2 != r2End);
-
-    pNextRect = RegionTop(pReg);
-
-    /* Start off current rectangle */
-    if (r1->x1 < r2->x1) {
-        x1 = r1->x1;
-        x2 = r1->x2;
-        r1++;
-    }
-    else {
-        x1 = r2->x1;
-        x2 = r2->x2;
-        r2++;
-    }
-    while (r1 != r1End && r2 != r2End) {
-        if (r1->x1 < r2->x1)
-            MERGERECT(r1)
-            else
-            MERGERECT(r2);
-    }
-
-    /* Finish off whoever (if any) is left */
-    if (r1 != r1End) {
-        do {
-            MERGERECT(r1);
-        } while (r1 != r1End);
-    }
-    else if (r2 != r2End) {
-        do {
-            MERGERECT(r2);
-        } while (r2 != r2End);
-    }
-
-    /* Add current rectangle */
-    NEWRECT(pReg, pNextRect, x1, y1, x2, y2);
-
-    return TRUE;
-}
-
 /*======================================================================
  *	    Batch Rectangle Union
  *====================================================================*/
@@ -1100,6 +670,142 @@ QuickSortRects(BoxRec rects[], int numRects)
     } while (numRects > 1);
 }
 
+/*-
+ *-----------------------------------------------------------------------
+ * RegionSweep --
+ *	Build a region from boxes sorted by (y1, x1) in one pass down the
+ *	screen.  Between two consecutive box edges the set of boxes crossing
+ *	the scanlines does not change; those boxes are kept sorted by x1 and
+ *	merged into one band, which is then coalesced with the band above.
+ *
+ * Results:
+ *	TRUE if successful.
+ *
+ * Side Effects:
+ *	pReg, which must have no rectangle storage, receives the union of
+ *	the boxes.  Empty boxes are ignored.  pOverlap is set to TRUE if any
+ *	boxes overlapped.
+ *
+ *-----------------------------------------------------------------------
+ */
+static Bool
+RegionSweep(RegionPtr pReg, BoxPtr boxes, int numBoxes, Bool *pOverlap)
+{
+    BoxPtr *active;             /* Boxes crossing the band, by x1       */
+    BoxPtr *merged;             /* Room to merge new boxes into active  */
+    BoxPtr *tmp;
+    int numActive, next, i, j, k;
+    int prevBand, curBand;
+    int y1, y2, x1, x2;
+    int minX, maxX;
+    int numRects;
+    BoxPtr pNextRect;
+
+    active = xallocarray(2 * numBoxes, sizeof(BoxPtr));
+    if (!active)
+        return RegionBreak(pReg);
+    merged = active + numBoxes;
+
+    numActive = next = 0;
+    prevBand = 0;
+    y1 = y2 = 0;
+    minX = MAXSHORT;
+    maxX = MINSHORT;
+    while (next < numBoxes || numActive) {
+        /* Skip down to the next box across a gap */
+        if (!numActive)
+            y1 = boxes[next].y1;
+        else
+            y1 = y2;
+
+        /* Merge the boxes starting on this scanline into the active set */
+        if (next < numBoxes && boxes[next].y1 == y1) {
+            i = j = 0;
+            while (next < numBoxes && boxes[next].y1 == y1) {
+                BoxPtr box = &boxes[next++];
+
+                if (box->x1 >= box->x2 || box->y1 >= box->y2)
+                    continue;
+                while (i < numActive && active[i]->x1 <= box->x1)
+                    merged[j++] = active[i++];
+                merged[j++] = box;
+            }
+            while (i < numActive)
+                merged[j++] = active[i++];
+            numActive = j;
+            tmp = active;
+            active = merged;
+            merged = tmp;
+            if (!numActive)
+                continue;
+        }
+
+        /* The band ends where the next box starts or an active one ends */
+        y2 = next < numBoxes ? boxes[next].y1 : MAXSHORT + 1;
+        for (i = 0; i < numActive; i++)
+            if (active[i]->y2 < y2)
+                y2 = active[i]->y2;
+
+        curBand = pReg->data->numRects;
+        x1 = active[0]->x1;
+        x2 = active[0]->x2;
+        for (i = 1; i <= numActive; i++) {
+            if (i < numActive && active[i]->x1 <= x2) {
+                if (active[i]->x1 < x2)
+                    *pOverlap = TRUE;
+                if (active[i]->x2 > x2)
+                    x2 = active[i]->x2;
+                continue;
+            }
+            RECTALLOC_BAIL(pReg, 1, bail);
+            pNextRect = RegionTop(pReg);
+            ADDRECT(pNextRect, x1, y1, x2, y2);
+            pReg->data->numRects++;
+            if (x1 < minX)
+                minX = x1;
+            if (x2 > maxX)
+                maxX = x2;
+            if (i < numActive) {
+                x1 = active[i]->x1;
+                x2 = active[i]->x2;
+            }
+        }
+        Coalesce(pReg, prevBand, curBand);
+
+        /* Drop the boxes that end with the band */
+        for (i = k = 0; i < numActive; i++)
+            if (active[i]->y2 > y2)
+                active[k++] = active[i];
+        numActive = k;
+    }
+    free(active < merged ? active : merged);
+
+    numRects = pReg->data->numRects;
+    if (!numRects) {
+        xfreeData(pReg);
+        pReg->extents = RegionEmptyBox;
+        pReg->data = &RegionEmptyData;
+        return TRUE;
+    }
+    pReg->extents.x1 = minX;
+    pReg->extents.y1 = RegionBoxptr(pReg)->y1;
+    pReg->extents.x2 = maxX;
+    pReg->extents.y2 = RegionEnd(pReg)->y2;
+    if (numRects == 1) {
+        xfreeData(pReg);
+        pReg->data = NULL;
+    }
+    else {
+        DOWNSIZE(pReg, numRects);
+    }
+    good(pReg);
+    return TRUE;
+
+ bail:
+    free(active < merged ? active : merged);
+    return FALSE;
+}
+
 /*-
  *-----------------------------------------------------------------------
  * RegionValidate --
@@ -1119,15 +825,9 @@ QuickSortRects(BoxRec rects[], int numRects)
  *      Step 1. Sort the rectangles into ascending order with primary key y1
  *		and secondary key x1.
  *
- *      Step 2. Split the rectangles into the minimum number of proper y-x
- *		banded regions.  This may require horizontally merging
- *		rectangles, and vertically coalescing bands.  With any luck,
- *		this step in an identity tranformation (ala the Box widget),
- *		or a coalescing into 1 box (ala Menus).
- *
- *	Step 3. Merge the separate regions down to a single region by calling
- *		Union.  Maximize the work each Union call does by using
- *		a binary merge.
+ *      Step 2. Sweep down the sorted rectangles, emitting each band once
+ *		with its rectangles merged horizontally, and coalescing it
+ *		vertically with the band above (see RegionSweep).
  *
  *-----------------------------------------------------------------------
  */
@@ -1135,25 +835,9 @@ QuickSortRects(BoxRec rects[], int numRects)
 Bool
 RegionValidate(RegionPtr badreg, Bool *pOverlap)
 {
-    /* Descriptor for regions under construction  in Step 2. */
-    typedef struct {
-        RegionRec reg;
-        int prevBand;
-        int curBand;
-    } RegionInfo;
-
     int numRects;               /* Original numRects for badreg         */
-    RegionInfo *ri;             /* Array of current regions             */
-    int numRI;                  /* Number of entries used in ri         */
-    int sizeRI;                 /* Number of entries available in ri    */
-    int i;                      /* Index into rects                     */
-    int j;                      /* Index into ri                        */
-    RegionInfo *rit;            /* &ri[j]                                */
-    RegionPtr reg;              /* ri[j].reg                     */
-    BoxPtr box;                 /* Current box in rects                 */
-    BoxPtr riBox;               /* Last box in ri[j].reg                */
-    RegionPtr hreg;             /* ri[j_half].reg                        */
-    Bool ret = TRUE;
+    RegionRec old;              /* badreg's unsorted rectangles         */
+    Bool ret;
 
     *pOverlap = FALSE;
     if (!badreg->data) {
@@ -1180,135 +864,93 @@ RegionValidate(RegionPtr badreg, Bool *pOverlap)
     }
 
     /* Step 1: Sort the rects array into ascending (y1, x1) order */
-    QuickSortRects(RegionBoxptr(badreg), numRects);
-
-    /* Step 2: Scatter the sorted array into the minimum number of regions */
-
-    /* Set up the first region to be the first rectangle in badreg */
-    /* Note that step 2 code will never overflow the ri[0].reg rects array */
-    ri = (RegionInfo *) malloc(4 * sizeof(RegionInfo));
-    if (!ri)
-        return RegionBreak(badreg);
-    sizeRI = 4;
-    numRI = 1;
-    ri[0].prevBand = 0;
-    ri[0].curBand = 0;
-    ri[0].reg = *badreg;
-    box = RegionBoxptr(&ri[0].reg);
-    ri[0].reg.extents = *box;
-    ri[0].reg.data->numRects = 1;
-
-    /* Now scatter rectangles into the minimum set of valid regions.  If the
-       next rectangle to be added to a region would force an existing rectangle
-       in the region to be split up in order to maintain y-x banding, just
-       forget it.  Try the next region.  If it doesn't fit cleanly into any
-       region, make a new one. */
-
-    for (i = numRects; --i > 0;) {
-        box++;
-        /* Look for a region to append box to */
-        for (j = numRI, rit = ri; --j >= 0; rit++) {
-            reg = &rit->reg;
-            riBox = RegionEnd(reg);
-
-            if (box->y1 == riBox->y1 && box->y2 == riBox->y2) {
-                /* box is in same band as riBox.  Merge or append it */
-                if (box->x1 <= riBox->x2) {
-                    /* Merge it with riBox */
-                    if (box->x1 < riBox->x2)
-                        *pOverlap = TRUE;
-                    if (box->x2 > riBox->x2)
-                        riBox->x2 = box->x2;
-                }
-                else {
-                    RECTALLOC_BAIL(reg, 1, bail);
-                    *RegionTop(reg) = *box;
-                    reg->data->numRects++;
-                }
-                goto NextRect;  /* So sue me */
-            }
-            else if (box->y1 >= riBox->y2) {
-                /* Put box into new band */
-                if (reg->extents.x2 < riBox->x2)
-                    reg->extents.x2 = riBox->x2;
-                if (reg->extents.x1 > box->x1)
-                    reg->extents.x1 = box->x1;
-                Coalesce(reg, rit->prevBand, rit->curBand);
-                rit->curBand = reg->data->numRects;
-                RECTALLOC_BAIL(reg, 1, bail);
-                *RegionTop(reg) = *box;
-                reg->data->numRects++;
-                goto NextRect;
-            }
-            /* Well, this region was inappropriate.  Try the next one. */
-        }                       /* for j */
-
-        /* Uh-oh.  No regions were appropriate.  Create a new one. */
-        if (sizeRI == numRI) {
-            /* Oops, allocate space for new region information */
-            sizeRI <<= 1;
-            rit = (RegionInfo *) reallocarray(ri, sizeRI, sizeof(RegionInfo));
-            if (!rit)
-                goto bail;
-            ri = rit;
-            rit = &ri[numRI];
-        }
-        numRI++;
-        rit->prevBand = 0;
-        rit->curBand = 0;
-        rit->reg.extents = *box;
-        rit->reg.data = NULL;
-        if (!RegionRectAlloc(&rit->reg, (i + numRI) / numRI))   /* MUST force allocation */
-            goto bail;
- NextRect:;
-    }                           /* for i */
-
-    /* Make a final pass over each region in order to Coalesce and set
-       extents.x2 and extents.y2 */
-
-    for (j = numRI, rit = ri; --j >= 0; rit++) {
-        reg = &rit->reg;
-        riBox = RegionEnd(reg);
-        reg->extents.y2 = riBox->y2;
-        if (reg->extents.x2 < riBox->x2)
-            reg->extents.x2 = riBox->x2;
-        Coalesce(reg, rit->prevBand, rit->curBand);
-        if (reg->data->numRects == 1) { /* keep unions happy below */
-            xfreeData(reg);
-            reg->data = NULL;
+    if (numRects > 1)
+        QuickSortRects(RegionBoxptr(badreg), numRects);
+
+    /* Step 2: Sweep the sorted rects into a new region */
+    old = *badreg;
+    badreg->extents = RegionEmptyBox;
+    badreg->data = &RegionEmptyData;
+    ret = RegionSweep(badreg, RegionBoxptr(&old), numRects, pOverlap);
+    xfreeData(&old);
+    return ret;
+}
+
+/*======================================================================
+ *	    Region Builder
+ *====================================================================*/
+
+/**
+ * Add nBoxes boxes, in any order and possibly overlapping, to the region
+ * being built.  On allocation failure the built region will be broken.
+ */
+Bool
+RegionBuilderAddBoxes(RegionBuilderPtr builder, const BoxRec *boxes,
+                      int nBoxes)
+{
+    if (nBoxes <= 0)
+        return TRUE;
+    if (nBoxes > builder->size - builder->numBoxes) {
+        int size = builder->size ? builder->size : 64;
+        BoxPtr new;
+
+        while (size - builder->numBoxes < nBoxes)
+            size *= 2;
+        new = reallocarray(builder->boxes, size, sizeof(BoxRec));
+        if (!new) {
+            builder->broken = TRUE;
+            return FALSE;
         }
+        builder->boxes = new;
+        builder->size = size;
     }
+    memcpy(builder->boxes + builder->numBoxes, boxes, nBoxes * sizeof(BoxRec));
+    builder->numBoxes += nBoxes;
+    return TRUE;
+}
 
-    /* Step 3: Union all regions into a single region */
-    while (numRI > 1) {
-        int half = numRI / 2;
-
-        for (j = numRI & 1; j < (half + (numRI & 1)); j++) {
-            reg = &ri[j].reg;
-            hreg = &ri[j + half].reg;
-            if (!RegionOp(reg, reg, hreg, RegionUnionO, TRUE, TRUE, pOverlap))
-                ret = FALSE;
-            if (hreg->extents.x1 < reg->extents.x1)
-                reg->extents.x1 = hreg->extents.x1;
-            if (hreg->extents.y1 < reg->extents.y1)
-                reg->extents.y1 = hreg->extents.y1;
-            if (hreg->extents.x2 > reg->extents.x2)
-                reg->extents.x2 = hreg->extents.x2;
-            if (hreg->extents.y2 > reg->extents.y2)
-                reg->extents.y2 = hreg->extents.y2;
-            xfreeData(hreg);
-        }
-        numRI -= half;
+Bool
+RegionBuilderAddRegion(RegionBuilderPtr builder, RegionPtr pReg)
+{
+    if (RegionNar(pReg)) {
+        builder->broken = TRUE;
+        return FALSE;
     }
-    *badreg = ri[0].reg;
-    free(ri);
-    good(badreg);
-    return ret;
- bail:
-    for (i = 0; i < numRI; i++)
-        xfreeData(&ri[i].reg);
-    free(ri);
-    return RegionBreak(badreg);
+    return RegionBuilderAddBoxes(builder, RegionRects(pReg),
+                                 RegionNumRects(pReg));
+}
+
+/**
+ * Replace the contents of pReg with the union of every box added since the
+ * builder was initialized or last finished, sorting and banding them once.
+ * The builder is left empty, ready to be reused.
+ *
+ * @return FALSE, with pReg broken, if memory ran out.
+ */
+Bool
+RegionBuilderFinish(RegionBuilderPtr builder, RegionPtr pReg)
+{
+    int numBoxes = builder->numBoxes;
+    Bool overlap;
+
+    RegionEmpty(pReg);
+    builder->numBoxes = 0;
+    if (builder->broken) {
+        builder->broken = FALSE;
+        return RegionBreak(pReg);
+    }
+    if (!numBoxes)
+        return TRUE;
+    if (numBoxes > 1)
+        QuickSortRects(builder->boxes, numBoxes);
+    return RegionSweep(pReg, builder->boxes, numBoxes, &overlap);
+}
+
+void
+RegionBuilderUninit(RegionBuilderPtr builder)
+{
+    free(builder->boxes);
+    RegionBuilderInit(builder);
 }
 
 RegionPtr
@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <X11/X.h>
+#include "misc.h"
+#include "dixstruct.h"
+#include "extnsionst.h"
+#include "reqstats.h"
+
+/*
+ * Request accounting.  Per-client totals live in the ClientRec, the
+ * per-opcode totals are kept in a table indexed by major opcode.  Core
+ * requests only need a single entry, extension majors get one entry per
+ * minor opcode, allocated the first time a request for them shows up.
+ */
+
+Bool ReqStatsEnabled = TRUE;
+unsigned long ReqStatsResets;
+
+static ReqStatsPtr opcodeStats[256];
+
+static inline void
+ReqStatsAdd(ReqStatsPtr stats, CARD32 bytes_in, CARD32 elapsed)
+{
+    stats->count++;
+    stats->time += elapsed;
+    stats->bytes_in += bytes_in;
+    if (elapsed > stats->max_time)
+        stats->max_time = elapsed;
+}
+
+static ReqStatsPtr
+ReqStatsGetOpcode(int major, int minor)
+{
+    ReqStatsPtr stats = opcodeStats[major];
+
+    if (!stats) {
+        stats = calloc(major < EXTENSION_BASE ? 1 : 256, sizeof(ReqStatsRec));
+        if (!stats)
+            return NULL;
+        opcodeStats[major] = stats;
+    }
+
+    return major < EXTENSION_BASE ? stats : stats + minor;
+}
+
+/**
+ * Account for a single request.  client may be NULL if the client went
+ * away while the request was being processed, in which case only the
+ * opcode totals are updated.
+ *
+ * bytes_out is not added to the client totals, WriteToClient() already
+ * counts those as they are queued.
+ */
+void
+ReqStatsAccount(ClientPtr client, int major, int minor,
+                CARD32 bytes_in, CARD32 bytes_out, CARD32 elapsed)
+{
+    ReqStatsPtr stats;
+
+    if (client)
+        ReqStatsAdd(&client->reqStats, bytes_in, elapsed);
+
+    stats = ReqStatsGetOpcode(major, minor);
+    if (stats) {
+        ReqStatsAdd(stats, bytes_in, elapsed);
+        stats->bytes_out += bytes_out;
+    }
+}
+
+/**
+ * Call proc for every (major, minor) opcode that has been seen since the
+ * last reset.  Core requests are reported with a minor opcode of 0.
+ */
+void
+ReqStatsForEach(ReqStatsProcPtr proc, void *closure)
+{
+    int major, minor;
+
+    for (major = 0; major < 256; major++) {
+        ReqStatsPtr stats = opcodeStats[major];
+        int nminor = major < EXTENSION_BASE ? 1 : 256;
+
+        if (!stats)
+            continue;
+
+        for (minor = 0; minor < nminor; minor++)
+            if (stats[minor].count)
+                (*proc) (major, minor, &stats[minor], closure);
+    }
+}
+
+void
+ReqStatsReset(void)
+{
+    int i;
+
+    ReqStatsResets++;
+    for (i = 0; i < 256; i++)
+        if (opcodeStats[i])
+            memset(opcodeStats[i], 0,
+                   (i < EXTENSION_BASE ? 1 : 256) * sizeof(ReqStatsRec));
+
+    for (i = 0; i < currentMaxClients; i++)
+        if (clients[i])
+            memset(&clients[i]->reqStats, 0, sizeof(ReqStatsRec));
+}
+
+/* Extension opcodes may be reassigned across server generations */
+void
+ReqStatsFree(void)
+{
+    int i;
+
+    for (i = 0; i < 256; i++) {
+        free(opcodeStats[i]);
+        opcodeStats[i] = NULL;
+    }
+}
@@ -105,8 +105,18 @@ Equipment Corporation.
  *      A resource ID is a 32 bit quantity, the upper 2 bits of which are
  *	off-limits for client-visible resources.  The next 8 bits are
  *      used as client ID, and the low 22 bits come from the client.
- *	A resource ID is "hashed" by extracting and xoring subfields
- *      (varying with the size of the hash table).
+ *	Each client has an open addressing hash table of resource IDs,
+ *	using Robin Hood insertion and backward shift deletion, that grows
+ *	without limit.  A slot points to the newest resource with its ID,
+ *	older resources with the same ID are chained behind it.  Every
+ *	resource is also on a per-client list of resources of its type, so
+ *	that FindClientResourcesByType need not walk the whole table.
+ *
+ *	Drawing requests tend to look up the same few drawables and GCs over
+ *	and over, so the results of recent lookups are kept in a small
+ *	per-client cache.  Any change to the client's resources that could
+ *	change a lookup result bumps the client's lookup generation, which
+ *	invalidates the whole cache.
  *
  *      It is sometimes necessary for the server to create an ID that looks
  *      like it belongs to a client.  This ID, however,  must not be one
@@ -142,6 +152,7 @@ Equipment Corporation.
 #include <assert.h>
 #include "registry.h"
 #include "gcstruct.h"
+#include "list.h"
 
 #ifdef XSERVER_DTRACE
 #include "probes.h"
@@ -149,27 +160,47 @@ Equipment Corporation.
 #define TypeNameString(t) LookupResourceName(t)
 #endif
 
-static void RebuildTable(int    /*client */
+static Bool RebuildTable(int    /*client */
     );
 
 #define SERVER_MINID 32
 
-#define INITBUCKETS 64
+#define INITSLOTS 64
 #define INITHASHSIZE 6
-#define MAXHASHSIZE 11
+
+#define LOOKUP_CACHE_SIZE 8     /* must be a power of two */
 
 typedef struct _Resource {
-    struct _Resource *next;
+    struct _Resource *next;     /* older resource with the same id */
+    struct xorg_list link;      /* in the client's list for this type */
     XID id;
-    RESTYPE type;
+    RESTYPE type;               /* RT_NONE for iteration markers */
     void *value;
 } ResourceRec, *ResourcePtr;
 
+typedef struct _ResourceSlot {
+    XID id;
+    ResourcePtr res;            /* NULL if the slot is free */
+} ResourceSlotRec, *ResourceSlotPtr;
+
+typedef struct _ResourceLookupCache {
+    XID id;
+    RESTYPE match;              /* type or class looked up */
+    Bool byClass;
+    unsigned int generation;
+    ResourcePtr res;
+} ResourceLookupCacheRec, *ResourceLookupCachePtr;
+
 typedef struct _ClientResource {
-    ResourcePtr *resources;
-    int elements;
-    int buckets;
-    int hashsize;               /* log(2)(buckets) */
+    ResourceSlotPtr slots;      /* NULL if the client is not in use */
+    int size;                   /* number of slots */
+    int hashsize;               /* log(2)(size) */
+    int used;                   /* slots in use */
+    int elements;               /* resources */
+    struct xorg_list *types;    /* resources of each type, oldest first */
+    int ntypes;
+    unsigned int generation;    /* of the lookup cache */
+    ResourceLookupCacheRec cache[LOOKUP_CACHE_SIZE];
     XID fakeID;
     XID endFakeID;
 } ClientResourceRec;
@@ -632,7 +663,7 @@ ResourceClientBits(void)
 Bool
 InitClientResources(ClientPtr client)
 {
-    int i, j;
+    int i;
 
     if (client == serverClient) {
         lastResourceType = RT_LASTPREDEF;
@@ -644,13 +675,18 @@ InitClientResources(ClientPtr client)
             return FALSE;
         memcpy(resourceTypes, predefTypes, sizeof(predefTypes));
     }
-    clientTable[i = client->index].resources =
-        malloc(INITBUCKETS * sizeof(ResourcePtr));
-    if (!clientTable[i].resources)
+    clientTable[i = client->index].slots =
+        calloc(INITSLOTS, sizeof(ResourceSlotRec));
+    if (!clientTable[i].slots)
         return FALSE;
-    clientTable[i].buckets = INITBUCKETS;
-    clientTable[i].elements = 0;
+    clientTable[i].size = INITSLOTS;
     clientTable[i].hashsize = INITHASHSIZE;
+    clientTable[i].used = 0;
+    clientTable[i].elements = 0;
+    clientTable[i].types = NULL;
+    clientTable[i].ntypes = 0;
+    memset(clientTable[i].cache, 0, sizeof(clientTable[i].cache));
+    clientTable[i].generation = 1;
     /* Many IDs allocated from the server client are visible to clients,
      * so we don't use the SERVER_BIT for them, but we have to start
      * past the magic value constants used in the protocol.  For normal
@@ -659,9 +695,6 @@ InitClientResources(ClientPtr client)
     clientTable[i].fakeID = client->clientAsMask |
         (client->index ? SERVER_BIT : SERVER_MINID);
     clientTable[i].endFakeID = (clientTable[i].fakeID | RESOURCE_ID_MASK) + 1;
-    for (j = 0; j < INITBUCKETS; j++) {
-        clientTable[i].resources[j] = NULL;
-    }
     return TRUE;
 }
 
@@ -693,18 +726,235 @@ HashResourceID(XID id, int numBits)
     }
 }
 
+/* Fibonacci hashing spreads the sequential IDs clients allocate evenly */
+static inline unsigned int
+ResourceSlotHash(XID id, int numBits)
+{
+    return ((CARD32) id * 0x9E3779B1U) >> (32 - numBits);
+}
+
+/* How far a slot's entry is from the slot it hashes to */
+static inline unsigned int
+ResourceSlotDistance(ClientResourceRec *rrec, unsigned int slot)
+{
+    return (slot - ResourceSlotHash(rrec->slots[slot].id, rrec->hashsize)) &
+        (rrec->size - 1);
+}
+
+static ResourceSlotPtr
+FindResourceSlot(ClientResourceRec *rrec, XID id)
+{
+    unsigned int mask = rrec->size - 1;
+    unsigned int i = ResourceSlotHash(id, rrec->hashsize);
+    unsigned int dist;
+
+    for (dist = 0;; dist++, i = (i + 1) & mask) {
+        ResourceSlotPtr slot = &rrec->slots[i];
+
+        if (!slot->res)
+            return NULL;
+        if (slot->id == id)
+            return slot;
+        /* id would have taken this slot from an entry closer to home */
+        if (ResourceSlotDistance(rrec, i) < dist)
+            return NULL;
+    }
+}
+
+/* Insert a slot for an id known not to be in the table yet */
+static void
+InsertResourceSlot(ClientResourceRec *rrec, XID id, ResourcePtr res)
+{
+    unsigned int mask = rrec->size - 1;
+    unsigned int i = ResourceSlotHash(id, rrec->hashsize);
+    unsigned int dist;
+    ResourceSlotRec entry = { id, res };
+
+    for (dist = 0;; dist++, i = (i + 1) & mask) {
+        ResourceSlotPtr slot = &rrec->slots[i];
+        unsigned int slot_dist;
+
+        if (!slot->res) {
+            *slot = entry;
+            rrec->used++;
+            return;
+        }
+        slot_dist = ResourceSlotDistance(rrec, i);
+        if (slot_dist < dist) {
+            ResourceSlotRec tmp = *slot;
+
+            *slot = entry;
+            entry = tmp;
+            dist = slot_dist;
+        }
+    }
+}
+
+/* Free a slot, moving the entries after it back towards their home */
+static void
+RemoveResourceSlot(ClientResourceRec *rrec, ResourceSlotPtr slot)
+{
+    unsigned int mask = rrec->size - 1;
+    unsigned int i = slot - rrec->slots;
+
+    for (;;) {
+        unsigned int next = (i + 1) & mask;
+
+        if (!rrec->slots[next].res || ResourceSlotDistance(rrec, next) == 0)
+            break;
+        rrec->slots[i] = rrec->slots[next];
+        i = next;
+    }
+    rrec->slots[i].res = NULL;
+    rrec->used--;
+}
+
+static Bool
+RebuildTable(int client)
+{
+    ClientResourceRec *rrec = &clientTable[client];
+    ResourceSlotPtr slots = rrec->slots;
+    int i, size = rrec->size;
+
+    rrec->slots = calloc(2 * size, sizeof(ResourceSlotRec));
+    if (!rrec->slots) {
+        rrec->slots = slots;
+        return FALSE;
+    }
+    rrec->size = 2 * size;
+    rrec->hashsize++;
+    rrec->used = 0;
+    for (i = 0; i < size; i++)
+        if (slots[i].res)
+            InsertResourceSlot(rrec, slots[i].id, slots[i].res);
+    free(slots);
+    return TRUE;
+}
+
+static inline void
+InvalidateLookupCache(ClientResourceRec *rrec)
+{
+    /* Entries of a wrapped generation could look valid again */
+    if (++rrec->generation == 0) {
+        memset(rrec->cache, 0, sizeof(rrec->cache));
+        rrec->generation = 1;
+    }
+}
+
+/* Find the newest resource with the given id and type or class */
+static inline ResourcePtr
+LookupResource(int client, XID id, RESTYPE match, Bool byClass)
+{
+    ClientResourceRec *rrec = &clientTable[client];
+    ResourceLookupCachePtr entry = &rrec->cache[id & (LOOKUP_CACHE_SIZE - 1)];
+    ResourceSlotPtr slot;
+    ResourcePtr res = NULL;
+
+    if (entry->generation == rrec->generation && entry->id == id &&
+        entry->match == match && entry->byClass == byClass)
+        return entry->res;
+
+    if ((slot = FindResourceSlot(rrec, id))) {
+        for (res = slot->res; res; res = res->next)
+            if (byClass ? (res->type & match) : (res->type == match))
+                break;
+    }
+    if (res) {
+        entry->id = id;
+        entry->match = match;
+        entry->byClass = byClass;
+        entry->generation = rrec->generation;
+        entry->res = res;
+    }
+    return res;
+}
+
+/* Make sure the client has a list for resources of the given type */
+static Bool
+GrowTypeLists(ClientResourceRec *rrec, RESTYPE type)
+{
+    struct xorg_list *types;
+    int i, ntypes = max(lastResourceType, type & TypeMask) + 1;
+
+    types = xallocarray(ntypes, sizeof(struct xorg_list));
+    if (!types)
+        return FALSE;
+
+    /* The first and last resources of each list point at its head */
+    for (i = 0; i < ntypes; i++) {
+        if (i < rrec->ntypes && !xorg_list_is_empty(&rrec->types[i])) {
+            types[i] = rrec->types[i];
+            types[i].next->prev = &types[i];
+            types[i].prev->next = &types[i];
+        }
+        else
+            xorg_list_init(&types[i]);
+    }
+    free(rrec->types);
+    rrec->types = types;
+    rrec->ntypes = ntypes;
+    return TRUE;
+}
+
+/*
+ * Call func for each resource on the client's list for the given type,
+ * until it returns TRUE.  func may add and free resources, including the
+ * one it was given: a marker placed after the current resource says where
+ * to continue.  Other walks' markers are skipped.
+ */
+typedef Bool (*ResourceWalkFunc) (ResourcePtr res, void *closure);
+
+static Bool
+WalkTypeList(int client, int type, ResourceWalkFunc func, void *closure)
+{
+    ResourceRec marker = { .type = RT_NONE };
+    struct xorg_list *node;
+    Bool done = FALSE;
+
+    if (type >= clientTable[client].ntypes)
+        return FALSE;
+
+    /* The list head moves if GrowTypeLists is called, so look it up again
+     * each time round */
+    node = clientTable[client].types[type].next;
+    while (!done && node != &clientTable[client].types[type]) {
+        ResourcePtr res = xorg_list_entry(node, ResourceRec, link);
+
+        if (res->type == RT_NONE) {
+            node = node->next;
+            continue;
+        }
+
+        xorg_list_add(&marker.link, &res->link);
+        done = (*func) (res, closure);
+        node = marker.link.next;
+        xorg_list_del(&marker.link);
+    }
+    return done;
+}
+
+static Bool
+WalkClientResources(int client, RESTYPE type, ResourceWalkFunc func,
+                    void *closure)
+{
+    int i;
+
+    if (type)
+        return WalkTypeList(client, type & TypeMask, func, closure);
+
+    for (i = 1; i < clientTable[client].ntypes; i++)
+        if (WalkTypeList(client, i, func, closure))
+            return TRUE;
+    return FALSE;
+}
+
 static XID
 AvailableID(int client, XID id, XID maxid, XID goodid)
 {
-    ResourcePtr res;
-
     if ((goodid >= id) && (goodid <= maxid))
         return goodid;
     for (; id <= maxid; id++) {
-        res = clientTable[client].resources[HashResourceID(id, clientTable[client].hashsize)];
-        while (res && (res->id != id))
-            res = res->next;
-        if (!res)
+        if (!FindResourceSlot(&clientTable[client], id))
             return id;
     }
     return 0;
@@ -714,8 +964,7 @@ void
 GetXIDRange(int client, Bool server, XID *minp, XID *maxp)
 {
     XID id, maxid;
-    ResourcePtr *resp;
-    ResourcePtr res;
+    ResourceSlotPtr slot;
     int i;
     XID goodid;
 
@@ -724,18 +973,18 @@ GetXIDRange(int client, Bool server, XID *minp, XID *maxp)
         id |= client ? SERVER_BIT : SERVER_MINID;
     maxid = id | RESOURCE_ID_MASK;
     goodid = 0;
-    for (resp = clientTable[client].resources, i = clientTable[client].buckets;
-         --i >= 0;) {
-        for (res = *resp++; res; res = res->next) {
-            if ((res->id < id) || (res->id > maxid))
-                continue;
-            if (((res->id - id) >= (maxid - res->id)) ?
-                (goodid = AvailableID(client, id, res->id - 1, goodid)) :
-                !(goodid = AvailableID(client, res->id + 1, maxid, goodid)))
-                maxid = res->id - 1;
-            else
-                id = res->id + 1;
-        }
+    for (slot = clientTable[client].slots, i = clientTable[client].size;
+         --i >= 0; slot++) {
+        if (!slot->res)
+            continue;
+        if ((slot->id < id) || (slot->id > maxid))
+            continue;
+        if (((slot->id - id) >= (maxid - slot->id)) ?
+            (goodid = AvailableID(client, id, slot->id - 1, goodid)) :
+            !(goodid = AvailableID(client, slot->id + 1, maxid, goodid)))
+            maxid = slot->id - 1;
+        else
+            id = slot->id + 1;
     }
     if (id > maxid)
         id = maxid = 0;
@@ -813,77 +1062,51 @@ AddResource(XID id, RESTYPE type, void *value)
 {
     int client;
     ClientResourceRec *rrec;
-    ResourcePtr res, *head;
+    ResourceSlotPtr slot;
+    ResourcePtr res;
 
 #ifdef XSERVER_DTRACE
     XSERVER_RESOURCE_ALLOC(id, type, value, TypeNameString(type));
 #endif
     client = CLIENT_ID(id);
     rrec = &clientTable[client];
-    if (!rrec->buckets) {
+    if (!rrec->slots) {
         ErrorF("[dix] AddResource(%lx, %x, %lx), client=%d \n",
                (unsigned long) id, type, (unsigned long) value, client);
         FatalError("client not in use\n");
     }
-    if ((rrec->elements >= 4 * rrec->buckets) && (rrec->hashsize < MAXHASHSIZE))
-        RebuildTable(client);
-    head = &rrec->resources[HashResourceID(id, clientTable[client].hashsize)];
+    /* Keep the load below 7/8.  If the table can't grow, it can still be
+     * filled up, as long as one slot stays free to end probes. */
+    slot = FindResourceSlot(rrec, id);
+    if (!slot && 8 * (rrec->used + 1) > 7 * rrec->size &&
+        !RebuildTable(client) && rrec->used + 1 >= rrec->size)
+        goto fail;
+    if ((type & TypeMask) >= rrec->ntypes && !GrowTypeLists(rrec, type))
+        goto fail;
     res = malloc(sizeof(ResourceRec));
-    if (!res) {
-        (*resourceTypes[type & TypeMask].deleteFunc) (value, id);
-        return FALSE;
-    }
-    res->next = *head;
+    if (!res)
+        goto fail;
     res->id = id;
     res->type = type;
     res->value = value;
-    *head = res;
+    if (slot) {
+        /* The new resource hides older ones with the same id */
+        res->next = slot->res;
+        slot->res = res;
+        InvalidateLookupCache(rrec);
+    }
+    else {
+        res->next = NULL;
+        InsertResourceSlot(rrec, id, res);
+    }
+    xorg_list_append(&res->link, &rrec->types[type & TypeMask]);
     rrec->elements++;
     CallResourceStateCallback(ResourceStateAdding, res);
     return TRUE;
-}
-
-static void
-RebuildTable(int client)
-{
-    int j;
-    ResourcePtr res, next;
-    ResourcePtr **tails, *resources;
-    ResourcePtr **tptr, *rptr;
-
-    /*
-     * For now, preserve insertion order, since some ddx layers depend
-     * on resources being free in the opposite order they are added.
-     */
 
-    j = 2 * clientTable[client].buckets;
-    tails =  xallocarray(j, sizeof(ResourcePtr *));
-    if (!tails)
-        return;
-    resources =  xallocarray(j, sizeof(ResourcePtr));
-    if (!resources) {
-        free(tails);
-        return;
-    }
-    for (rptr = resources, tptr = tails; --j >= 0; rptr++, tptr++) {
-        *rptr = NULL;
-        *tptr = rptr;
-    }
-    clientTable[client].hashsize++;
-    for (j = clientTable[client].buckets,
-         rptr = clientTable[client].resources; --j >= 0; rptr++) {
-        for (res = *rptr; res; res = next) {
-            next = res->next;
-            res->next = NULL;
-            tptr = &tails[HashResourceID(res->id, clientTable[client].hashsize)];
-            **tptr = res;
-            *tptr = &res->next;
-        }
-    }
-    free(tails);
-    clientTable[client].buckets *= 2;
-    free(clientTable[client].resources);
-    clientTable[client].resources = resources;
+ fail:
+    (*resourceTypes[type & TypeMask].deleteFunc) (value, id);
+    return FALSE;
 }
 
 static void
@@ -897,38 +1120,42 @@ doFreeResource(ResourcePtr res, Bool skip)
     free(res);
 }
 
+/*
+ * Take res, found behind *prev in the chain of slot, out of the client's
+ * table.  The slot is freed along with the last resource of its id.
+ */
+static void
+UnlinkResource(ClientResourceRec *rrec, ResourceSlotPtr slot,
+               ResourcePtr *prev, ResourcePtr res)
+{
+#ifdef XSERVER_DTRACE
+    XSERVER_RESOURCE_FREE(res->id, res->type,
+                          res->value, TypeNameString(res->type));
+#endif
+    *prev = res->next;
+    if (!slot->res)
+        RemoveResourceSlot(rrec, slot);
+    xorg_list_del(&res->link);
+    rrec->elements--;
+    InvalidateLookupCache(rrec);
+}
+
 void
 FreeResource(XID id, RESTYPE skipDeleteFuncType)
 {
     int cid;
+    ClientResourceRec *rrec;
+    ResourceSlotPtr slot;
     ResourcePtr res;
-    ResourcePtr *prev, *head;
-    int *eltptr;
-    int elements;
-
-    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].buckets) {
-        head = &clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
-        eltptr = &clientTable[cid].elements;
 
-        prev = head;
-        while ((res = *prev)) {
-            if (res->id == id) {
-                RESTYPE rtype = res->type;
+    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].slots) {
+        rrec = &clientTable[cid];
 
-#ifdef XSERVER_DTRACE
-                XSERVER_RESOURCE_FREE(res->id, res->type,
-                                      res->value, TypeNameString(res->type));
-#endif
-                *prev = res->next;
-                elements = --*eltptr;
-
-                doFreeResource(res, rtype == skipDeleteFuncType);
-
-                if (*eltptr != elements)
-                    prev = head;        /* prev may no longer be valid */
-            }
-            else
-                prev = &res->next;
+        /* Free newest first; the delete functions may change the table */
+        while ((slot = FindResourceSlot(rrec, id))) {
+            res = slot->res;
+            UnlinkResource(rrec, slot, &slot->res, res);
+            doFreeResource(res, res->type == skipDeleteFuncType);
         }
     }
 }
@@ -937,28 +1164,18 @@ void
 FreeResourceByType(XID id, RESTYPE type, Bool skipFree)
 {
     int cid;
+    ResourceSlotPtr slot;
     ResourcePtr res;
-    ResourcePtr *prev, *head;
-
-    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].buckets) {
-        head = &clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
-
-        prev = head;
-        while ((res = *prev)) {
-            if (res->id == id && res->type == type) {
-#ifdef XSERVER_DTRACE
-                XSERVER_RESOURCE_FREE(res->id, res->type,
-                                      res->value, TypeNameString(res->type));
-#endif
-                *prev = res->next;
-                clientTable[cid].elements--;
+    ResourcePtr *prev;
 
+    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].slots &&
+        (slot = FindResourceSlot(&clientTable[cid], id))) {
+        for (prev = &slot->res; (res = *prev); prev = &res->next) {
+            if (res->type == type) {
+                UnlinkResource(&clientTable[cid], slot, prev, res);
                 doFreeResource(res, skipFree);
-
                 break;
             }
-            else
-                prev = &res->next;
         }
     }
 }
@@ -973,51 +1190,51 @@ Bool
 ChangeResourceValue(XID id, RESTYPE rtype, void *value)
 {
     int cid;
+    ResourceSlotPtr slot;
     ResourcePtr res;
 
-    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].buckets) {
-        res = clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
-
-        for (; res; res = res->next)
-            if ((res->id == id) && (res->type == rtype)) {
+    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].slots &&
+        (slot = FindResourceSlot(&clientTable[cid], id))) {
+        for (res = slot->res; res; res = res->next)
+            if (res->type == rtype) {
                 res->value = value;
+                InvalidateLookupCache(&clientTable[cid]);
                 return TRUE;
             }
     }
     return FALSE;
 }
 
-/* Note: if func adds or deletes resources, then func can get called
- * more than once for some resources.  If func adds new resources,
- * func might or might not get called for them.  func cannot both
- * add and delete an equal number of resources!
+/* Note: func may add or delete resources.  It is called exactly once for
+ * every resource that existed when the walk started and still exists when
+ * the walk gets to it.  If func adds new resources, func might or might
+ * not get called for them.
  */
 
+typedef struct {
+    FindResType func;
+    void *cdata;
+} FindResourcesRec;
+
+static Bool
+FindResourcesWalk(ResourcePtr res, void *closure)
+{
+    FindResourcesRec *find = closure;
+
+    (*find->func) (res->value, res->id, find->cdata);
+    return FALSE;
+}
+
 void
 FindClientResourcesByType(ClientPtr client,
                           RESTYPE type, FindResType func, void *cdata)
 {
-    ResourcePtr *resources;
-    ResourcePtr this, next;
-    int i, elements;
-    int *eltptr;
+    FindResourcesRec find = { func, cdata };
 
     if (!client)
         client = serverClient;
 
-    resources = clientTable[client->index].resources;
-    eltptr = &clientTable[client->index].elements;
-    for (i = 0; i < clientTable[client->index].buckets; i++) {
-        for (this = resources[i]; this; this = next) {
-            next = this->next;
-            if (!type || this->type == type) {
-                elements = *eltptr;
-                (*func) (this->value, this->id, cdata);
-                if (*eltptr != elements)
-                    next = resources[i];        /* start over */
-            }
-        }
-    }
+    WalkClientResources(client->index, type, FindResourcesWalk, &find);
 }
 
 void FindSubResources(void *resource,
@@ -1029,28 +1246,45 @@ void FindSubResources(void *resource,
     rtype.findSubResFunc(resource, func, cdata);
 }
 
+typedef struct {
+    FindAllRes func;
+    void *cdata;
+} FindAllResourcesRec;
+
+static Bool
+FindAllResourcesWalk(ResourcePtr res, void *closure)
+{
+    FindAllResourcesRec *find = closure;
+
+    (*find->func) (res->value, res->id, res->type, find->cdata);
+    return FALSE;
+}
+
 void
 FindAllClientResources(ClientPtr client, FindAllRes func, void *cdata)
 {
-    ResourcePtr *resources;
-    ResourcePtr this, next;
-    int i, elements;
-    int *eltptr;
+    FindAllResourcesRec find = { func, cdata };
 
     if (!client)
         client = serverClient;
 
-    resources = clientTable[client->index].resources;
-    eltptr = &clientTable[client->index].elements;
-    for (i = 0; i < clientTable[client->index].buckets; i++) {
-        for (this = resources[i]; this; this = next) {
-            next = this->next;
-            elements = *eltptr;
-            (*func) (this->value, this->id, this->type, cdata);
-            if (*eltptr != elements)
-                next = resources[i];    /* start over */
-        }
-    }
+    WalkClientResources(client->index, 0, FindAllResourcesWalk, &find);
+}
+
+typedef struct {
+    FindComplexResType func;
+    void *cdata;
+    void *value;
+} LookupComplexRec;
+
+static Bool
+LookupComplexWalk(ResourcePtr res, void *closure)
+{
+    LookupComplexRec *lookup = closure;
+
+    /* workaround func freeing the type as DRI1 does */
+    lookup->value = res->value;
+    return (*lookup->func) (lookup->value, res->id, lookup->cdata);
 }
 
 void *
@@ -1058,74 +1292,48 @@ LookupClientResourceComplex(ClientPtr client,
                             RESTYPE type,
                             FindComplexResType func, void *cdata)
 {
-    ResourcePtr *resources;
-    ResourcePtr this, next;
-    void *value;
-    int i;
+    LookupComplexRec lookup = { func, cdata, NULL };
 
     if (!client)
         client = serverClient;
 
-    resources = clientTable[client->index].resources;
-    for (i = 0; i < clientTable[client->index].buckets; i++) {
-        for (this = resources[i]; this; this = next) {
-            next = this->next;
-            if (!type || this->type == type) {
-                /* workaround func freeing the type as DRI1 does */
-                value = this->value;
-                if ((*func) (value, this->id, cdata))
-                    return value;
-            }
-        }
-    }
+    if (WalkClientResources(client->index, type, LookupComplexWalk, &lookup))
+        return lookup.value;
     return NULL;
 }
 
+static Bool
+FreeNeverRetainWalk(ResourcePtr res, void *closure)
+{
+    if (res->type & RC_NEVERRETAIN) {
+        ClientResourceRec *rrec = closure;
+        ResourceSlotPtr slot = FindResourceSlot(rrec, res->id);
+        ResourcePtr *prev = &slot->res;
+
+        while (*prev != res)
+            prev = &(*prev)->next;
+        UnlinkResource(rrec, slot, prev, res);
+        doFreeResource(res, FALSE);
+    }
+    return FALSE;
+}
+
 void
 FreeClientNeverRetainResources(ClientPtr client)
 {
-    ResourcePtr *resources;
-    ResourcePtr this;
-    ResourcePtr *prev;
-    int j, elements;
-    int *eltptr;
-
     if (!client)
         return;
 
-    resources = clientTable[client->index].resources;
-    eltptr = &clientTable[client->index].elements;
-    for (j = 0; j < clientTable[client->index].buckets; j++) {
-        prev = &resources[j];
-        while ((this = *prev)) {
-            RESTYPE rtype = this->type;
-
-            if (rtype & RC_NEVERRETAIN) {
-#ifdef XSERVER_DTRACE
-                XSERVER_RESOURCE_FREE(this->id, this->type,
-                                      this->value, TypeNameString(this->type));
-#endif
-                *prev = this->next;
-                clientTable[client->index].elements--;
-                elements = *eltptr;
-
-                doFreeResource(this, FALSE);
-
-                if (*eltptr != elements)
-                    prev = &resources[j];       /* prev may no longer be valid */
-            }
-            else
-                prev = &this->next;
-        }
-    }
+    WalkClientResources(client->index, 0, FreeNeverRetainWalk,
+                        &clientTable[client->index]);
 }
 
 void
 FreeClientResources(ClientPtr client)
 {
-    ResourcePtr *resources;
+    ClientResourceRec *rrec;
     ResourcePtr this;
-    int j;
+    int i;
 
     /* This routine shouldn't be called with a null client, but just in
        case ... */
@@ -1135,35 +1343,29 @@ FreeClientResources(ClientPtr client)
 
     HandleSaveSet(client);
 
-    resources = clientTable[client->index].resources;
-    for (j = 0; j < clientTable[client->index].buckets; j++) {
-        /* It may seem silly to update the head of this resource list as
-           we delete the members, since the entire list will be deleted any way,
-           but there are some resource deletion functions "FreeClientPixels" for
-           one which do a LookupID on another resource id (a Colormap id in this
-           case), so the resource list must be kept valid up to the point that
-           it is deleted, so every time we delete a resource, we must update the
-           head, just like in FreeResource. I hope that this doesn't slow down
-           mass deletion appreciably. PRH */
-
-        ResourcePtr *head;
-
-        head = &resources[j];
-
-        for (this = *head; this; this = *head) {
-#ifdef XSERVER_DTRACE
-            XSERVER_RESOURCE_FREE(this->id, this->type,
-                                  this->value, TypeNameString(this->type));
-#endif
-            *head = this->next;
-            clientTable[client->index].elements--;
-
-            doFreeResource(this, FALSE);
+    rrec = &clientTable[client->index];
+
+    /* Free the resources of each id newest first, keeping the table valid
+       all the time: some resource deletion functions, "FreeClientPixels"
+       for one, look up other resources of the client (a Colormap id in
+       this case).  Deleting a slot moves later entries back into it, and
+       delete functions may free other resources, so keep going until the
+       table is empty. */
+    while (rrec->used) {
+        for (i = 0; i < rrec->size; i++) {
+            while ((this = rrec->slots[i].res)) {
+                UnlinkResource(rrec, &rrec->slots[i], &rrec->slots[i].res,
+                               this);
+                doFreeResource(this, FALSE);
+            }
         }
     }
-    free(clientTable[client->index].resources);
-    clientTable[client->index].resources = NULL;
-    clientTable[client->index].buckets = 0;
+    free(rrec->slots);
+    rrec->slots = NULL;
+    rrec->size = 0;
+    free(rrec->types);
+    rrec->types = NULL;
+    rrec->ntypes = 0;
 }
 
 void
@@ -1172,7 +1374,7 @@ FreeAllResources(void)
     int i;
 
     for (i = currentMaxClients; --i >= 0;) {
-        if (clientTable[i].buckets)
+        if (clientTable[i].slots)
             FreeClientResources(clients[i]);
     }
 }
@@ -1213,13 +1415,8 @@ dixLookupResourceByType(void **result, XID id, RESTYPE rtype,
     if ((rtype & TypeMask) > lastResourceType)
         return BadImplementation;
 
-    if ((cid < LimitClients) && clientTable[cid].buckets) {
-        res = clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
-
-        for (; res; res = res->next)
-            if (res->id == id && res->type == rtype)
-                break;
-    }
+    if ((cid < LimitClients) && clientTable[cid].slots)
+        res = LookupResource(cid, id, rtype, FALSE);
     if (!res)
         return resourceTypes[rtype & TypeMask].errorValue;
 
@@ -1246,13 +1443,8 @@ dixLookupResourceByClass(void **result, XID id, RESTYPE rclass,
 
     *result = NULL;
 
-    if ((cid < LimitClients) && clientTable[cid].buckets) {
-        res = clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
-
-        for (; res; res = res->next)
-            if (res->id == id && (res->type & rclass))
-                break;
-    }
+    if ((cid < LimitClients) && clientTable[cid].slots)
+        res = LookupResource(cid, id, rclass, TRUE);
     if (!res)
         return BadValue;
 
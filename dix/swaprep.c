@@ -57,12 +57,47 @@ SOFTWARE.
 #include "swaprep.h"
 #include "globals.h"
 
+#include <stddef.h>
+#include <strings.h>
+
 static void SwapFontInfo(xQueryFontReply * pr);
 
 static void SwapCharInfo(xCharInfo * pInfo);
 
 static void SwapFont(xQueryFontReply * pr, Bool hasGlyphs);
 
+/*
+ * Fixed-layout replies are swapped from a table of the fields to swap
+ * rather than field by field: bit n of shorts swaps the CARD16 at byte
+ * offset 2n, and bit n of longs the CARD32 at byte offset 4n.
+ */
+typedef struct _ReplyLayout {
+    CARD32 shorts;
+    CARD16 longs;
+} ReplyLayoutRec;
+
+#define SWAP16(type, field) (1U << (offsetof(type, field) >> 1))
+#define SWAP32(type, field) (1U << (offsetof(type, field) >> 2))
+
+static void
+SwapReplyFields(void *pRep, const ReplyLayoutRec * layout)
+{
+    CARD16 *shorts = pRep;
+    CARD32 *longs = pRep;
+    unsigned int mask;
+
+    for (mask = layout->shorts; mask; mask &= mask - 1) {
+        int i = ffs(mask) - 1;
+
+        shorts[i] = lswaps(shorts[i]);
+    }
+    for (mask = layout->longs; mask; mask &= mask - 1) {
+        int i = ffs(mask) - 1;
+
+        longs[i] = lswapl(longs[i]);
+    }
+}
+
 /**
  * Thanks to Jack Palevich for testing and subsequently rewriting all this
  *
@@ -71,16 +106,8 @@ static void SwapFont(xQueryFontReply * pr, Bool hasGlyphs);
 void
 Swap32Write(ClientPtr pClient, int size, CARD32 *pbuf)
 {
-    int i;
-
-    size >>= 2;
-    for (i = 0; i < size; i++)
-        /* brackets are mandatory here, because "swapl" macro expands
-           to several statements */
-    {
-        swapl(&pbuf[i]);
-    }
-    WriteToClient(pClient, size << 2, pbuf);
+    SwapLongs(pbuf, size >> 2);
+    WriteToClient(pClient, size & ~3, pbuf);
 }
 
 /**
@@ -92,7 +119,7 @@ CopySwap32Write(ClientPtr pClient, int size, CARD32 *pbuf)
 {
     int bufsize = size;
     CARD32 *pbufT;
-    CARD32 *from, *to, *fromLast, *toLast;
+    CARD32 *from, *fromLast;
     CARD32 tmpbuf[1];
 
     /* Allocate as big a buffer as we can... */
@@ -111,19 +138,11 @@ CopySwap32Write(ClientPtr pClient, int size, CARD32 *pbuf)
     from = pbuf;
     fromLast = from + size;
     while (from < fromLast) {
-        int nbytes;
-
-        to = pbufT;
-        toLast = to + min(bufsize, fromLast - from);
-        nbytes = (toLast - to) << 2;
-        while (to < toLast) {
-            /* can't write "cpswapl(*from++, *to++)" because cpswapl is a macro
-               that evaulates its args more than once */
-            cpswapl(*from, *to);
-            from++;
-            to++;
-        }
-        WriteToClient(pClient, nbytes, pbufT);
+        int count = min(bufsize, fromLast - from);
+
+        CopySwapLongs(pbufT, from, count);
+        from += count;
+        WriteToClient(pClient, count << 2, pbufT);
     }
 
     if (pbufT != tmpbuf)
@@ -139,7 +158,7 @@ CopySwap16Write(ClientPtr pClient, int size, short *pbuf)
 {
     int bufsize = size;
     short *pbufT;
-    short *from, *to, *fromLast, *toLast;
+    short *from, *fromLast;
     short tmpbuf[2];
 
     /* Allocate as big a buffer as we can... */
@@ -158,19 +177,11 @@ CopySwap16Write(ClientPtr pClient, int size, short *pbuf)
     from = pbuf;
     fromLast = from + size;
     while (from < fromLast) {
-        int nbytes;
-
-        to = pbufT;
-        toLast = to + min(bufsize, fromLast - from);
-        nbytes = (toLast - to) << 1;
-        while (to < toLast) {
-            /* can't write "cpswaps(*from++, *to++)" because cpswaps is a macro
-               that evaulates its args more than once */
-            cpswaps(*from, *to);
-            from++;
-            to++;
-        }
-        WriteToClient(pClient, nbytes, pbufT);
+        int count = min(bufsize, fromLast - from);
+
+        CopySwapShorts((CARD16 *) pbufT, (const CARD16 *) from, count);
+        from += count;
+        WriteToClient(pClient, count << 1, pbufT);
     }
 
     if (pbufT != tmpbuf)
@@ -190,77 +201,105 @@ void
 SGetWindowAttributesReply(ClientPtr pClient, int size,
                           xGetWindowAttributesReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swapl(&pRep->visualID);
-    swaps(&pRep->class);
-    swapl(&pRep->backingBitPlanes);
-    swapl(&pRep->backingPixel);
-    swapl(&pRep->colormap);
-    swapl(&pRep->allEventMasks);
-    swapl(&pRep->yourEventMask);
-    swaps(&pRep->doNotPropagateMask);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetWindowAttributesReply, sequenceNumber) |
+            SWAP16(xGetWindowAttributesReply, class) |
+            SWAP16(xGetWindowAttributesReply, doNotPropagateMask),
+        SWAP32(xGetWindowAttributesReply, length) |
+            SWAP32(xGetWindowAttributesReply, visualID) |
+            SWAP32(xGetWindowAttributesReply, backingBitPlanes) |
+            SWAP32(xGetWindowAttributesReply, backingPixel) |
+            SWAP32(xGetWindowAttributesReply, colormap) |
+            SWAP32(xGetWindowAttributesReply, allEventMasks) |
+            SWAP32(xGetWindowAttributesReply, yourEventMask)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SGetGeometryReply(ClientPtr pClient, int size, xGetGeometryReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->root);
-    swaps(&pRep->x);
-    swaps(&pRep->y);
-    swaps(&pRep->width);
-    swaps(&pRep->height);
-    swaps(&pRep->borderWidth);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetGeometryReply, sequenceNumber) |
+            SWAP16(xGetGeometryReply, x) |
+            SWAP16(xGetGeometryReply, y) |
+            SWAP16(xGetGeometryReply, width) |
+            SWAP16(xGetGeometryReply, height) |
+            SWAP16(xGetGeometryReply, borderWidth),
+        SWAP32(xGetGeometryReply, root)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SQueryTreeReply(ClientPtr pClient, int size, xQueryTreeReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swapl(&pRep->root);
-    swapl(&pRep->parent);
-    swaps(&pRep->nChildren);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xQueryTreeReply, sequenceNumber) |
+            SWAP16(xQueryTreeReply, nChildren),
+        SWAP32(xQueryTreeReply, length) |
+            SWAP32(xQueryTreeReply, root) |
+            SWAP32(xQueryTreeReply, parent)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SInternAtomReply(ClientPtr pClient, int size, xInternAtomReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->atom);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xInternAtomReply, sequenceNumber),
+        SWAP32(xInternAtomReply, atom)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SGetAtomNameReply(ClientPtr pClient, int size, xGetAtomNameReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swaps(&pRep->nameLength);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetAtomNameReply, sequenceNumber) |
+            SWAP16(xGetAtomNameReply, nameLength),
+        SWAP32(xGetAtomNameReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SGetPropertyReply(ClientPtr pClient, int size, xGetPropertyReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swapl(&pRep->propertyType);
-    swapl(&pRep->bytesAfter);
-    swapl(&pRep->nItems);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetPropertyReply, sequenceNumber),
+        SWAP32(xGetPropertyReply, length) |
+            SWAP32(xGetPropertyReply, propertyType) |
+            SWAP32(xGetPropertyReply, bytesAfter) |
+            SWAP32(xGetPropertyReply, nItems)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SListPropertiesReply(ClientPtr pClient, int size, xListPropertiesReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swaps(&pRep->nProperties);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xListPropertiesReply, sequenceNumber) |
+            SWAP16(xListPropertiesReply, nProperties),
+        SWAP32(xListPropertiesReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -268,22 +307,30 @@ void
 SGetSelectionOwnerReply(ClientPtr pClient, int size,
                         xGetSelectionOwnerReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->owner);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetSelectionOwnerReply, sequenceNumber),
+        SWAP32(xGetSelectionOwnerReply, owner)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SQueryPointerReply(ClientPtr pClient, int size, xQueryPointerReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->root);
-    swapl(&pRep->child);
-    swaps(&pRep->rootX);
-    swaps(&pRep->rootY);
-    swaps(&pRep->winX);
-    swaps(&pRep->winY);
-    swaps(&pRep->mask);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xQueryPointerReply, sequenceNumber) |
+            SWAP16(xQueryPointerReply, rootX) |
+            SWAP16(xQueryPointerReply, rootY) |
+            SWAP16(xQueryPointerReply, winX) |
+            SWAP16(xQueryPointerReply, winY) |
+            SWAP16(xQueryPointerReply, mask),
+        SWAP32(xQueryPointerReply, root) |
+            SWAP32(xQueryPointerReply, child)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -314,27 +361,39 @@ SwapTimeCoordWrite(ClientPtr pClient, int size, xTimecoord * pRep)
 void
 SGetMotionEventsReply(ClientPtr pClient, int size, xGetMotionEventsReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swapl(&pRep->nEvents);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetMotionEventsReply, sequenceNumber),
+        SWAP32(xGetMotionEventsReply, length) |
+            SWAP32(xGetMotionEventsReply, nEvents)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 STranslateCoordsReply(ClientPtr pClient, int size, xTranslateCoordsReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->child);
-    swaps(&pRep->dstX);
-    swaps(&pRep->dstY);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xTranslateCoordsReply, sequenceNumber) |
+            SWAP16(xTranslateCoordsReply, dstX) |
+            SWAP16(xTranslateCoordsReply, dstY),
+        SWAP32(xTranslateCoordsReply, child)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SGetInputFocusReply(ClientPtr pClient, int size, xGetInputFocusReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->focus);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetInputFocusReply, sequenceNumber),
+        SWAP32(xGetInputFocusReply, focus)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -342,8 +401,12 @@ SGetInputFocusReply(ClientPtr pClient, int size, xGetInputFocusReply * pRep)
 void
 SQueryKeymapReply(ClientPtr pClient, int size, xQueryKeymapReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xQueryKeymapReply, sequenceNumber),
+        SWAP32(xQueryKeymapReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -412,23 +475,31 @@ void
 SQueryTextExtentsReply(ClientPtr pClient, int size,
                        xQueryTextExtentsReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swaps(&pRep->fontAscent);
-    swaps(&pRep->fontDescent);
-    swaps(&pRep->overallAscent);
-    swaps(&pRep->overallDescent);
-    swapl(&pRep->overallWidth);
-    swapl(&pRep->overallLeft);
-    swapl(&pRep->overallRight);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xQueryTextExtentsReply, sequenceNumber) |
+            SWAP16(xQueryTextExtentsReply, fontAscent) |
+            SWAP16(xQueryTextExtentsReply, fontDescent) |
+            SWAP16(xQueryTextExtentsReply, overallAscent) |
+            SWAP16(xQueryTextExtentsReply, overallDescent),
+        SWAP32(xQueryTextExtentsReply, overallWidth) |
+            SWAP32(xQueryTextExtentsReply, overallLeft) |
+            SWAP32(xQueryTextExtentsReply, overallRight)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SListFontsReply(ClientPtr pClient, int size, xListFontsReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swaps(&pRep->nFonts);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xListFontsReply, sequenceNumber) |
+            SWAP16(xListFontsReply, nFonts),
+        SWAP32(xListFontsReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -443,18 +514,26 @@ SListFontsWithInfoReply(ClientPtr pClient, int size,
 void
 SGetFontPathReply(ClientPtr pClient, int size, xGetFontPathReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swaps(&pRep->nPaths);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetFontPathReply, sequenceNumber) |
+            SWAP16(xGetFontPathReply, nPaths),
+        SWAP32(xGetFontPathReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SGetImageReply(ClientPtr pClient, int size, xGetImageReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swapl(&pRep->visual);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetImageReply, sequenceNumber),
+        SWAP32(xGetImageReply, length) |
+            SWAP32(xGetImageReply, visual)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
     /* Fortunately, image doesn't need swapping */
 }
@@ -463,44 +542,60 @@ void
 SListInstalledColormapsReply(ClientPtr pClient, int size,
                              xListInstalledColormapsReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swaps(&pRep->nColormaps);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xListInstalledColormapsReply, sequenceNumber) |
+            SWAP16(xListInstalledColormapsReply, nColormaps),
+        SWAP32(xListInstalledColormapsReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SAllocColorReply(ClientPtr pClient, int size, xAllocColorReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swaps(&pRep->red);
-    swaps(&pRep->green);
-    swaps(&pRep->blue);
-    swapl(&pRep->pixel);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xAllocColorReply, sequenceNumber) |
+            SWAP16(xAllocColorReply, red) |
+            SWAP16(xAllocColorReply, green) |
+            SWAP16(xAllocColorReply, blue),
+        SWAP32(xAllocColorReply, pixel)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SAllocNamedColorReply(ClientPtr pClient, int size, xAllocNamedColorReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->pixel);
-    swaps(&pRep->exactRed);
-    swaps(&pRep->exactGreen);
-    swaps(&pRep->exactBlue);
-    swaps(&pRep->screenRed);
-    swaps(&pRep->screenGreen);
-    swaps(&pRep->screenBlue);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xAllocNamedColorReply, sequenceNumber) |
+            SWAP16(xAllocNamedColorReply, exactRed) |
+            SWAP16(xAllocNamedColorReply, exactGreen) |
+            SWAP16(xAllocNamedColorReply, exactBlue) |
+            SWAP16(xAllocNamedColorReply, screenRed) |
+            SWAP16(xAllocNamedColorReply, screenGreen) |
+            SWAP16(xAllocNamedColorReply, screenBlue),
+        SWAP32(xAllocNamedColorReply, pixel)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SAllocColorCellsReply(ClientPtr pClient, int size, xAllocColorCellsReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swaps(&pRep->nPixels);
-    swaps(&pRep->nMasks);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xAllocColorCellsReply, sequenceNumber) |
+            SWAP16(xAllocColorCellsReply, nPixels) |
+            SWAP16(xAllocColorCellsReply, nMasks),
+        SWAP32(xAllocColorCellsReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -508,12 +603,16 @@ void
 SAllocColorPlanesReply(ClientPtr pClient, int size,
                        xAllocColorPlanesReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swaps(&pRep->nPixels);
-    swapl(&pRep->redMask);
-    swapl(&pRep->greenMask);
-    swapl(&pRep->blueMask);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xAllocColorPlanesReply, sequenceNumber) |
+            SWAP16(xAllocColorPlanesReply, nPixels),
+        SWAP32(xAllocColorPlanesReply, length) |
+            SWAP32(xAllocColorPlanesReply, redMask) |
+            SWAP32(xAllocColorPlanesReply, greenMask) |
+            SWAP32(xAllocColorPlanesReply, blueMask)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -543,39 +642,57 @@ SQColorsExtend(ClientPtr pClient, int size, xrgb * prgb)
 void
 SQueryColorsReply(ClientPtr pClient, int size, xQueryColorsReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swaps(&pRep->nColors);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xQueryColorsReply, sequenceNumber) |
+            SWAP16(xQueryColorsReply, nColors),
+        SWAP32(xQueryColorsReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SLookupColorReply(ClientPtr pClient, int size, xLookupColorReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swaps(&pRep->exactRed);
-    swaps(&pRep->exactGreen);
-    swaps(&pRep->exactBlue);
-    swaps(&pRep->screenRed);
-    swaps(&pRep->screenGreen);
-    swaps(&pRep->screenBlue);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xLookupColorReply, sequenceNumber) |
+            SWAP16(xLookupColorReply, exactRed) |
+            SWAP16(xLookupColorReply, exactGreen) |
+            SWAP16(xLookupColorReply, exactBlue) |
+            SWAP16(xLookupColorReply, screenRed) |
+            SWAP16(xLookupColorReply, screenGreen) |
+            SWAP16(xLookupColorReply, screenBlue),
+        0
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SQueryBestSizeReply(ClientPtr pClient, int size, xQueryBestSizeReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swaps(&pRep->width);
-    swaps(&pRep->height);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xQueryBestSizeReply, sequenceNumber) |
+            SWAP16(xQueryBestSizeReply, width) |
+            SWAP16(xQueryBestSizeReply, height),
+        0
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SListExtensionsReply(ClientPtr pClient, int size, xListExtensionsReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xListExtensionsReply, sequenceNumber),
+        SWAP32(xListExtensionsReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -583,8 +700,12 @@ void
 SGetKeyboardMappingReply(ClientPtr pClient, int size,
                          xGetKeyboardMappingReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetKeyboardMappingReply, sequenceNumber),
+        SWAP32(xGetKeyboardMappingReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -592,8 +713,12 @@ void
 SGetPointerMappingReply(ClientPtr pClient, int size,
                         xGetPointerMappingReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetPointerMappingReply, sequenceNumber),
+        SWAP32(xGetPointerMappingReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -601,8 +726,12 @@ void
 SGetModifierMappingReply(ClientPtr pClient, int size,
                          xGetModifierMappingReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetModifierMappingReply, sequenceNumber),
+        SWAP32(xGetModifierMappingReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -610,11 +739,15 @@ void
 SGetKeyboardControlReply(ClientPtr pClient, int size,
                          xGetKeyboardControlReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swapl(&pRep->ledMask);
-    swaps(&pRep->bellPitch);
-    swaps(&pRep->bellDuration);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetKeyboardControlReply, sequenceNumber) |
+            SWAP16(xGetKeyboardControlReply, bellPitch) |
+            SWAP16(xGetKeyboardControlReply, bellDuration),
+        SWAP32(xGetKeyboardControlReply, length) |
+            SWAP32(xGetKeyboardControlReply, ledMask)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -622,19 +755,29 @@ void
 SGetPointerControlReply(ClientPtr pClient, int size,
                         xGetPointerControlReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swaps(&pRep->accelNumerator);
-    swaps(&pRep->accelDenominator);
-    swaps(&pRep->threshold);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetPointerControlReply, sequenceNumber) |
+            SWAP16(xGetPointerControlReply, accelNumerator) |
+            SWAP16(xGetPointerControlReply, accelDenominator) |
+            SWAP16(xGetPointerControlReply, threshold),
+        0
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
 void
 SGetScreenSaverReply(ClientPtr pClient, int size, xGetScreenSaverReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swaps(&pRep->timeout);
-    swaps(&pRep->interval);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xGetScreenSaverReply, sequenceNumber) |
+            SWAP16(xGetScreenSaverReply, timeout) |
+            SWAP16(xGetScreenSaverReply, interval),
+        0
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
@@ -657,9 +800,13 @@ SLHostsExtend(ClientPtr pClient, int size, char *buf)
 void
 SListHostsReply(ClientPtr pClient, int size, xListHostsReply * pRep)
 {
-    swaps(&pRep->sequenceNumber);
-    swapl(&pRep->length);
-    swaps(&pRep->nHosts);
+    static const ReplyLayoutRec layout = {
+        SWAP16(xListHostsReply, sequenceNumber) |
+            SWAP16(xListHostsReply, nHosts),
+        SWAP32(xListHostsReply, length)
+    };
+
+    SwapReplyFields(pRep, &layout);
     WriteToClient(pClient, size, pRep);
 }
 
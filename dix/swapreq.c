@@ -58,62 +58,129 @@ SOFTWARE.
 
 /* Thanks to Jack Palevich for testing and subsequently rewriting all this */
 
-/* Byte swap a list of longs */
+/*
+ * Array byte swapping, used for request and reply payloads from clients
+ * of the other byte order.  Sixteen bytes are swapped at a time with
+ * whichever vector instructions the compiler targets; anything left over,
+ * and builds without vector support, go through lswapl/lswaps.  dst may
+ * equal src, and neither needs more than natural alignment.
+ */
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define SWAP_VECTOR 1
+typedef __m128i SwapVector;
+#define SwapLoad(p) _mm_loadu_si128((const __m128i *) (p))
+#define SwapStore(p, v) _mm_storeu_si128((__m128i *) (p), v)
+#define SwapVector32(v) _mm_shuffle_epi8(v, _mm_set_epi8(12, 13, 14, 15, \
+    8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3))
+#define SwapVector16(v) _mm_shuffle_epi8(v, _mm_set_epi8(14, 15, 12, 13, \
+    10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SWAP_VECTOR 1
+typedef __m128i SwapVector;
+#define SwapLoad(p) _mm_loadu_si128((const __m128i *) (p))
+#define SwapStore(p, v) _mm_storeu_si128((__m128i *) (p), v)
+#define SwapVector16(v) _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8))
+/* swap the bytes in each half, then the halves in each long */
+#define SwapVector32(v) SwapHalves(SwapVector16(v))
+#define SwapHalves(v) _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xb1), 0xb1)
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SWAP_VECTOR 1
+typedef uint8x16_t SwapVector;
+#define SwapLoad(p) vld1q_u8((const uint8_t *) (p))
+#define SwapStore(p, v) vst1q_u8((uint8_t *) (p), v)
+#define SwapVector32(v) vrev32q_u8(v)
+#define SwapVector16(v) vrev16q_u8(v)
+#endif
+
+/* Copy count longs from src to dst, byte swapping each */
 void
-SwapLongs(CARD32 *list, unsigned long count)
+CopySwapLongs(CARD32 *dst, const CARD32 *src, unsigned long count)
 {
+#ifdef SWAP_VECTOR
     while (count >= 8) {
-        swapl(list + 0);
-        swapl(list + 1);
-        swapl(list + 2);
-        swapl(list + 3);
-        swapl(list + 4);
-        swapl(list + 5);
-        swapl(list + 6);
-        swapl(list + 7);
-        list += 8;
+        SwapVector a = SwapLoad(src);
+        SwapVector b = SwapLoad(src + 4);
+
+        SwapStore(dst, SwapVector32(a));
+        SwapStore(dst + 4, SwapVector32(b));
+        src += 8;
+        dst += 8;
         count -= 8;
     }
-    if (count != 0) {
-        do {
-            swapl(list);
-            list++;
-        } while (--count != 0);
+    if (count >= 4) {
+        SwapVector a = SwapLoad(src);
+
+        SwapStore(dst, SwapVector32(a));
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+#else
+    while (count >= 4) {
+        CARD32 a = src[0], b = src[1], c = src[2], d = src[3];
+
+        dst[0] = lswapl(a);
+        dst[1] = lswapl(b);
+        dst[2] = lswapl(c);
+        dst[3] = lswapl(d);
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+#endif
+    while (count != 0) {
+        *dst++ = lswapl(*src++);
+        count--;
     }
 }
 
-/* Byte swap a list of shorts */
+/* Copy count shorts from src to dst, byte swapping each */
 void
-SwapShorts(short *list, unsigned long count)
+CopySwapShorts(CARD16 *dst, const CARD16 *src, unsigned long count)
 {
+#ifdef SWAP_VECTOR
     while (count >= 16) {
-        swaps(list + 0);
-        swaps(list + 1);
-        swaps(list + 2);
-        swaps(list + 3);
-        swaps(list + 4);
-        swaps(list + 5);
-        swaps(list + 6);
-        swaps(list + 7);
-        swaps(list + 8);
-        swaps(list + 9);
-        swaps(list + 10);
-        swaps(list + 11);
-        swaps(list + 12);
-        swaps(list + 13);
-        swaps(list + 14);
-        swaps(list + 15);
-        list += 16;
+        SwapVector a = SwapLoad(src);
+        SwapVector b = SwapLoad(src + 8);
+
+        SwapStore(dst, SwapVector16(a));
+        SwapStore(dst + 8, SwapVector16(b));
+        src += 16;
+        dst += 16;
         count -= 16;
     }
-    if (count != 0) {
-        do {
-            swaps(list);
-            list++;
-        } while (--count != 0);
+    if (count >= 8) {
+        SwapVector a = SwapLoad(src);
+
+        SwapStore(dst, SwapVector16(a));
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+#endif
+    while (count != 0) {
+        *dst++ = lswaps(*src++);
+        count--;
     }
 }
 
+/* Byte swap a list of longs */
+void
+SwapLongs(CARD32 *list, unsigned long count)
+{
+    CopySwapLongs(list, list, count);
+}
+
+/* Byte swap a list of shorts */
+void
+SwapShorts(short *list, unsigned long count)
+{
+    CopySwapShorts((CARD16 *) list, (const CARD16 *) list, count);
+}
+
 /* The following is used for all requests that have
    no fields to be swapped (except "length") */
 int
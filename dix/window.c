@@ -484,6 +484,8 @@ SetWindowToDefaults(WindowPtr pWin)
 
     pWin->valdata = NULL;
     pWin->optional = NULL;
+    pWin->childIndex = NULL;
+    pWin->childRank = 0;
     pWin->cursorIsNone = TRUE;
 
     pWin->backingStore = NotUseful;
@@ -599,8 +601,11 @@ CreateRootWindow(ScreenPtr pScreen)
     pWin->optional->dontPropagateMask = 0;
     pWin->optional->otherEventMasks = 0;
     pWin->optional->otherClients = NULL;
+    pWin->optional->eventInterest = NULL;
     pWin->optional->passiveGrabs = NULL;
+    pWin->optional->grabIndex = NULL;
     pWin->optional->userProps = NULL;
+    pWin->optional->propIndex = NULL;
     pWin->optional->backingBitPlanes = ~0L;
     pWin->optional->backingPixel = 0;
     pWin->optional->boundingShape = NULL;
@@ -859,7 +864,7 @@ CreateWindow(Window wid, WindowPtr pParent, int x, int y, unsigned w,
 
     if (visual != ancwopt->visual) {
         if (!MakeWindowOptional(pWin)) {
-            dixFreeObjectWithPrivates(pWin, PRIVATE_WINDOW);
+            dixFreeScreenObjectWithPrivates(pScreen, pWin, PRIVATE_WINDOW);
             *error = BadAlloc;
             return NullWindow;
         }
@@ -875,7 +880,7 @@ CreateWindow(Window wid, WindowPtr pParent, int x, int y, unsigned w,
                       RT_WINDOW, pWin->parent,
                       DixCreateAccess | DixSetAttrAccess);
     if (*error != Success) {
-        dixFreeObjectWithPrivates(pWin, PRIVATE_WINDOW);
+        dixFreeScreenObjectWithPrivates(pScreen, pWin, PRIVATE_WINDOW);
         return NullWindow;
     }
 
@@ -918,6 +923,7 @@ CreateWindow(Window wid, WindowPtr pParent, int x, int y, unsigned w,
             pParent->lastChild = pWin;
         pParent->firstChild = pWin;
     }
+    ChildIndexStackChanged(pParent);
 
     SetWinSize(pWin);
     SetBorderSize(pWin);
@@ -1011,6 +1017,8 @@ FreeWindowResources(WindowPtr pWin)
     DeleteWindowFromAnySaveSet(pWin);
     DeleteWindowFromAnySelections(pWin);
     DeleteWindowFromAnyEvents(pWin, TRUE);
+    FreeChildIndex(pWin);
+    ChildIndexStackChanged(pWin->parent);
     RegionUninit(&pWin->clipList);
     RegionUninit(&pWin->winSize);
     RegionUninit(&pWin->borderClip);
@@ -1061,7 +1069,8 @@ CrushTree(WindowPtr pWin)
                 (*UnrealizeWindow) (pChild);
             }
             FreeWindowResources(pChild);
-            dixFreeObjectWithPrivates(pChild, PRIVATE_WINDOW);
+            dixFreeScreenObjectWithPrivates(pChild->drawable.pScreen, pChild,
+                                            PRIVATE_WINDOW);
             if ((pChild = pSib))
                 break;
             pChild = pParent;
@@ -1109,7 +1118,8 @@ DeleteWindow(void *value, XID wid)
     }
     else
         pWin->drawable.pScreen->root = NULL;
-    dixFreeObjectWithPrivates(pWin, PRIVATE_WINDOW);
+    dixFreeScreenObjectWithPrivates(pWin->drawable.pScreen, pWin,
+                                    PRIVATE_WINDOW);
     return Success;
 }
 
@@ -1702,6 +1712,7 @@ MoveWindowInStack(WindowPtr pWin, WindowPtr pNextSib)
                     pFirstChange = pFirstChange->nextSib;
             }
         }
+        ChildIndexStackChanged(pParent);
         if (pWin->drawable.pScreen->RestackWindow)
             (*pWin->drawable.pScreen->RestackWindow) (pWin, pOldNextSib);
     }
@@ -1752,6 +1763,7 @@ SetWinSize(WindowPtr pWin)
             RegionIntersect(&pWin->winSize, &pWin->winSize, wClipShape(pWin));
         RegionTranslate(&pWin->winSize, pWin->drawable.x, pWin->drawable.y);
     }
+    ChildIndexGeometryChanged(pWin);
 }
 
 void
@@ -1794,6 +1806,7 @@ SetBorderSize(WindowPtr pWin)
     else {
         RegionCopy(&pWin->borderSize, &pWin->winSize);
     }
+    ChildIndexGeometryChanged(pWin);
 }
 
 /**
@@ -2579,6 +2592,8 @@ ReparentWindow(WindowPtr pWin, WindowPtr pParent,
             pParent->lastChild = pWin;
         pParent->firstChild = pWin;
     }
+    ChildIndexStackChanged(pPriorParent);
+    ChildIndexStackChanged(pParent);
 
     pWin->origin.x = x + bw;
     pWin->origin.y = y + bw;
@@ -3419,8 +3434,11 @@ MakeWindowOptional(WindowPtr pWin)
     optional->dontPropagateMask = DontPropagateMasks[pWin->dontPropagate];
     optional->otherEventMasks = 0;
     optional->otherClients = NULL;
+    optional->eventInterest = NULL;
     optional->passiveGrabs = NULL;
+    optional->grabIndex = NULL;
     optional->userProps = NULL;
+    optional->propIndex = NULL;
     optional->backingBitPlanes = ~0L;
     optional->backingPixel = 0;
     optional->boundingShape = NULL;
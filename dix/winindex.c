@@ -0,0 +1,396 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+/*
+ * Spatial index over the children of a window.
+ *
+ * Parents with many children keep a fixed grid over their own area.
+ * Each cell lists the children whose border extents touch it, ordered
+ * top of the stack first, so hit testing and overlap marking only look
+ * at the children near a point or box instead of every sibling.  Boxes
+ * are kept relative to the parent, so moving the parent leaves the index
+ * alone; children outside the parent land in the edge cells.
+ *
+ * Moving or resizing a child updates its cells in place.  Restacking,
+ * adding or removing children only marks the index stale, and it is
+ * rebuilt by the next query.  Callers fall back to walking the sibling
+ * list whenever no index is returned.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <string.h>
+#include <strings.h>
+
+#include "misc.h"
+#include "windowstr.h"
+
+#define CHILD_INDEX_MIN 16      /* fewer children are walked linearly */
+#define CHILD_INDEX_GRID 16     /* cells along each side */
+
+typedef struct _ChildIndexCell {
+    int count;
+    int size;
+    WindowPtr *windows;         /* top of the stack first */
+} ChildIndexCellRec, *ChildIndexCellPtr;
+
+typedef struct _ChildIndex {
+    Bool stale;                 /* stacking changed, rebuild on next use */
+    int count;                  /* children indexed */
+    int width, height;          /* parent size the grid was built for */
+    int cell_w, cell_h;
+    WindowPtr *windows;         /* by rank, top of the stack first */
+    BoxPtr boxes;               /* border extents by rank, parent relative */
+    CARD32 *found;              /* scratch bitmap of ranks for box queries */
+    WindowPtr *result;          /* scratch result of box queries */
+    ChildIndexCellRec cells[CHILD_INDEX_GRID * CHILD_INDEX_GRID];
+} ChildIndexRec;
+
+static void
+ChildBox(WindowPtr pWin, BoxPtr box)
+{
+    WindowPtr pParent = pWin->parent;
+    int bw = wBorderWidth(pWin);
+
+    box->x1 = pWin->drawable.x - bw - pParent->drawable.x;
+    box->y1 = pWin->drawable.y - bw - pParent->drawable.y;
+    box->x2 = box->x1 + (int) pWin->drawable.width + 2 * bw;
+    box->y2 = box->y1 + (int) pWin->drawable.height + 2 * bw;
+}
+
+static inline int
+CellColumn(ChildIndexPtr index, int x)
+{
+    x /= index->cell_w;
+    return x < 0 ? 0 : x >= CHILD_INDEX_GRID ? CHILD_INDEX_GRID - 1 : x;
+}
+
+static inline int
+CellRow(ChildIndexPtr index, int y)
+{
+    y /= index->cell_h;
+    return y < 0 ? 0 : y >= CHILD_INDEX_GRID ? CHILD_INDEX_GRID - 1 : y;
+}
+
+/* The cells covered by box, which must not be empty */
+static void
+CellRange(ChildIndexPtr index, BoxPtr box, int *c1, int *r1, int *c2,
+          int *r2)
+{
+    *c1 = CellColumn(index, box->x1);
+    *r1 = CellRow(index, box->y1);
+    *c2 = CellColumn(index, box->x2 - 1);
+    *r2 = CellRow(index, box->y2 - 1);
+}
+
+static Bool
+CellInsert(ChildIndexCellPtr cell, WindowPtr pWin)
+{
+    int lo = 0, hi = cell->count;
+
+    if (cell->count == cell->size) {
+        int size = cell->size ? cell->size * 2 : 4;
+        WindowPtr *windows;
+
+        windows = reallocarray(cell->windows, size, sizeof(WindowPtr));
+        if (!windows)
+            return FALSE;
+        cell->windows = windows;
+        cell->size = size;
+    }
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+
+        if (cell->windows[mid]->childRank < pWin->childRank)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    memmove(&cell->windows[lo + 1], &cell->windows[lo],
+            (cell->count - lo) * sizeof(WindowPtr));
+    cell->windows[lo] = pWin;
+    cell->count++;
+    return TRUE;
+}
+
+static void
+CellRemove(ChildIndexCellPtr cell, WindowPtr pWin)
+{
+    int lo = 0, hi = cell->count;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+
+        if (cell->windows[mid]->childRank < pWin->childRank)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < cell->count && cell->windows[lo] == pWin) {
+        cell->count--;
+        memmove(&cell->windows[lo], &cell->windows[lo + 1],
+                (cell->count - lo) * sizeof(WindowPtr));
+    }
+}
+
+void
+FreeChildIndex(WindowPtr pWin)
+{
+    ChildIndexPtr index = pWin->childIndex;
+    int i;
+
+    if (!index)
+        return;
+    for (i = 0; i < CHILD_INDEX_GRID * CHILD_INDEX_GRID; i++)
+        free(index->cells[i].windows);
+    free(index->windows);
+    free(index->boxes);
+    free(index->found);
+    free(index->result);
+    free(index);
+    pWin->childIndex = NULL;
+}
+
+/**
+ * Note that children were added, removed or restacked.
+ */
+void
+ChildIndexStackChanged(WindowPtr pParent)
+{
+    if (pParent && pParent->childIndex)
+        pParent->childIndex->stale = TRUE;
+}
+
+/**
+ * Note that the position, size or border width of pWin changed.
+ */
+void
+ChildIndexGeometryChanged(WindowPtr pWin)
+{
+    ChildIndexPtr index;
+    BoxRec box, *old;
+    int c, r, c1, r1, c2, r2, oc1, or1, oc2, or2;
+
+    if (pWin->childIndex &&
+        (pWin->childIndex->width != pWin->drawable.width ||
+         pWin->childIndex->height != pWin->drawable.height))
+        pWin->childIndex->stale = TRUE;
+
+    if (!pWin->parent || !(index = pWin->parent->childIndex) || index->stale)
+        return;
+
+    ChildBox(pWin, &box);
+    old = &index->boxes[pWin->childRank];
+    if (box.x1 == old->x1 && box.y1 == old->y1 &&
+        box.x2 == old->x2 && box.y2 == old->y2)
+        return;
+
+    CellRange(index, old, &oc1, &or1, &oc2, &or2);
+    if (box.x1 < box.x2 && box.y1 < box.y2)
+        CellRange(index, &box, &c1, &r1, &c2, &r2);
+    else {
+        c1 = r1 = 0;
+        c2 = r2 = -1;
+    }
+    if (old->x1 >= old->x2 || old->y1 >= old->y2)
+        oc2 = or2 = -1;
+
+    for (r = or1; r <= or2; r++)
+        for (c = oc1; c <= oc2; c++)
+            if (r < r1 || r > r2 || c < c1 || c > c2)
+                CellRemove(&index->cells[r * CHILD_INDEX_GRID + c], pWin);
+    for (r = r1; r <= r2; r++)
+        for (c = c1; c <= c2; c++)
+            if (r < or1 || r > or2 || c < oc1 || c > oc2)
+                if (!CellInsert(&index->cells[r * CHILD_INDEX_GRID + c],
+                                pWin)) {
+                    index->stale = TRUE;
+                    return;
+                }
+    *old = box;
+}
+
+static Bool
+RebuildChildIndex(WindowPtr pParent, int count)
+{
+    ChildIndexPtr index = pParent->childIndex;
+    WindowPtr pChild;
+    int i, c, r, c1, r1, c2, r2;
+
+    for (i = 0; i < CHILD_INDEX_GRID * CHILD_INDEX_GRID; i++)
+        index->cells[i].count = 0;
+    if (count > index->count || !index->windows) {
+        free(index->windows);
+        free(index->boxes);
+        free(index->found);
+        free(index->result);
+        index->windows = xallocarray(count, sizeof(WindowPtr));
+        index->boxes = xallocarray(count, sizeof(BoxRec));
+        index->found = calloc((count + 31) / 32, sizeof(CARD32));
+        index->result = xallocarray(count, sizeof(WindowPtr));
+        if (!index->windows || !index->boxes || !index->found ||
+            !index->result)
+            return FALSE;
+    }
+    index->count = count;
+    index->width = pParent->drawable.width;
+    index->height = pParent->drawable.height;
+    index->cell_w = max(1, (index->width + CHILD_INDEX_GRID - 1) /
+                        CHILD_INDEX_GRID);
+    index->cell_h = max(1, (index->height + CHILD_INDEX_GRID - 1) /
+                        CHILD_INDEX_GRID);
+
+    for (pChild = pParent->firstChild, i = 0; pChild;
+         pChild = pChild->nextSib, i++) {
+        BoxPtr box = &index->boxes[i];
+
+        pChild->childRank = i;
+        index->windows[i] = pChild;
+        ChildBox(pChild, box);
+        if (box->x1 >= box->x2 || box->y1 >= box->y2)
+            continue;
+        CellRange(index, box, &c1, &r1, &c2, &r2);
+        for (r = r1; r <= r2; r++)
+            for (c = c1; c <= c2; c++)
+                if (!CellInsert(&index->cells[r * CHILD_INDEX_GRID + c],
+                                pChild))
+                    return FALSE;
+    }
+    index->stale = FALSE;
+    return TRUE;
+}
+
+/* Return an up to date index for pParent, or NULL to walk the children */
+static ChildIndexPtr
+GetChildIndex(WindowPtr pParent)
+{
+    WindowPtr pChild;
+    int count = 0;
+
+    if (pParent->childIndex && !pParent->childIndex->stale)
+        return pParent->childIndex;
+
+    for (pChild = pParent->firstChild; pChild; pChild = pChild->nextSib)
+        count++;
+    if (count < CHILD_INDEX_MIN) {
+        FreeChildIndex(pParent);
+        return NULL;
+    }
+
+    if (!pParent->childIndex) {
+        pParent->childIndex = calloc(1, sizeof(ChildIndexRec));
+        if (!pParent->childIndex)
+            return NULL;
+    }
+    if (!RebuildChildIndex(pParent, count)) {
+        FreeChildIndex(pParent);
+        return NULL;
+    }
+    return pParent->childIndex;
+}
+
+/**
+ * Find the children of pParent whose border extents may contain the
+ * point x, y in screen coordinates.
+ *
+ * @return The candidates, top of the stack first, or NULL if pParent
+ * has no index and its children must be walked instead.  The array is
+ * only valid until the window tree changes.
+ */
+WindowPtr *
+ChildIndexAtPoint(WindowPtr pParent, int x, int y, int *count)
+{
+    ChildIndexPtr index = GetChildIndex(pParent);
+    ChildIndexCellPtr cell;
+
+    if (!index)
+        return NULL;
+
+    x -= pParent->drawable.x;
+    y -= pParent->drawable.y;
+    cell = &index->cells[CellRow(index, y) * CHILD_INDEX_GRID +
+                         CellColumn(index, x)];
+    *count = cell->count;
+    return cell->windows;
+}
+
+/**
+ * Find the children of pParent from pFirst down whose border extents
+ * overlap box, in screen coordinates.
+ *
+ * @return The candidates, top of the stack first, or NULL if pParent
+ * has no index and its children must be walked instead.  The array is
+ * only valid until the next query on pParent.
+ */
+WindowPtr *
+ChildIndexInBox(WindowPtr pParent, BoxPtr box, WindowPtr pFirst, int *count)
+{
+    ChildIndexPtr index = GetChildIndex(pParent);
+    BoxRec rel;
+    int c, r, c1, r1, c2, r2, i, n = 0;
+
+    if (!index)
+        return NULL;
+
+    *count = 0;
+    rel.x1 = box->x1 - pParent->drawable.x;
+    rel.y1 = box->y1 - pParent->drawable.y;
+    rel.x2 = box->x2 - pParent->drawable.x;
+    rel.y2 = box->y2 - pParent->drawable.y;
+    if (rel.x1 >= rel.x2 || rel.y1 >= rel.y2)
+        return index->result;
+
+    CellRange(index, &rel, &c1, &r1, &c2, &r2);
+    for (r = r1; r <= r2; r++) {
+        for (c = c1; c <= c2; c++) {
+            ChildIndexCellPtr cell = &index->cells[r * CHILD_INDEX_GRID + c];
+
+            for (i = cell->count - 1; i >= 0; i--) {
+                int rank = cell->windows[i]->childRank;
+                BoxPtr child = &index->boxes[rank];
+
+                if (rank < pFirst->childRank)
+                    break;
+                if (child->x1 < rel.x2 && child->x2 > rel.x1 &&
+                    child->y1 < rel.y2 && child->y2 > rel.y1)
+                    index->found[rank / 32] |= 1U << (rank % 32);
+            }
+        }
+    }
+
+    for (i = pFirst->childRank / 32; i < (index->count + 31) / 32; i++) {
+        while (index->found[i]) {
+            int bit = ffs(index->found[i]) - 1;
+
+            index->found[i] &= index->found[i] - 1;
+            index->result[n++] = index->windows[i * 32 + bit];
+        }
+    }
+    *count = n;
+    return index->result;
+}
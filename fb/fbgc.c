@@ -121,13 +121,7 @@ fbValidateGC(GCPtr pGC, unsigned long changes, DrawablePtr pDrawable)
      * changed OR the window's clip has changed since the last validation
      * we need to recompute the composite clip
      */
-
-    if ((changes &
-         (GCClipXOrigin | GCClipYOrigin | GCClipMask | GCSubwindowMode)) ||
-        (pDrawable->serialNumber != (pGC->serialNumber & DRAWABLE_SERIAL_BITS))
-        ) {
-        miComputeCompositeClip(pGC, pDrawable);
-    }
+    miValidateCompositeClip(pGC, changes, pDrawable);
 
     if (pPriv->bpp != pDrawable->bitsPerPixel) {
         changes |= GCStipple | GCForeground | GCBackground | GCPlaneMask;
@@ -44,6 +44,7 @@
 #include "glxserver.h"
 #include "glamor_priv.h"
 #include "dpmsproc.h"
+#include "probes.h"
 
 static struct {
     Atom UTF8_STRING;
@@ -495,6 +496,12 @@ void xmir_repaint(struct xmir_window *xmir_win)
     if (!xmir_win->has_free_buffer)
         ErrorF("ERROR: xmir_repaint requested without a buffer to paint to\n");
 
+#ifdef XSERVER_SDT
+    if (XSERVER_REPAINT_START_ENABLED())
+        XSERVER_REPAINT_START(xmir_win->window->drawable.id,
+                              RegionNumRects(dirty));
+#endif
+
     xmir_screen = xmir_screen_get(xmir_win->window->drawable.pScreen);
     if (strcmp(xmir_screen->title, get_title_from_top_window)) {
         /* Fixed title mode. Never change it. */
@@ -567,6 +574,11 @@ void xmir_repaint(struct xmir_window *xmir_win)
 
     DamageEmpty(xmir_win->damage);
     xorg_list_del(&xmir_win->link_damage);
+
+#ifdef XSERVER_SDT
+    if (XSERVER_REPAINT_DONE_ENABLED())
+        XSERVER_REPAINT_DONE(xmir_win->window->drawable.id);
+#endif
 }
 
 void
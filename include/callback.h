@@ -64,6 +64,26 @@ typedef struct _CallbackList *CallbackListPtr;  /* also in misc.h */
 
 typedef void (*CallbackProcPtr) (CallbackListPtr *, void *, void *);
 
+typedef struct _CallbackRec {
+    CallbackProcPtr proc;
+    void *data;
+    Bool deleted;
+} CallbackRec, *CallbackPtr;
+
+/*
+ * Callbacks are kept in an array, newest last, and called newest first.
+ * A list is freed once its last callback is deleted, so a list pointer
+ * that is not NULL almost always has callbacks on it.
+ */
+typedef struct _CallbackList {
+    int inCallback;
+    Bool deleted;
+    int numDeleted;             /* marked deleted while in a callback */
+    int numCallbacks;           /* including those marked deleted */
+    int size;
+    CallbackPtr callbacks;
+} CallbackListRec;
+
 extern _X_EXPORT Bool AddCallback(CallbackListPtr *pcbl,
                                   CallbackProcPtr callback,
                                   void *data);
@@ -75,10 +95,16 @@ extern _X_EXPORT Bool DeleteCallback(CallbackListPtr *pcbl,
 extern _X_EXPORT void _CallCallbacks(CallbackListPtr *pcbl,
                                      void *call_data);
 
+static inline Bool
+CallbackListIsEmpty(CallbackListPtr cbl)
+{
+    return !cbl || cbl->numCallbacks == cbl->numDeleted;
+}
+
 static inline void
 CallCallbacks(CallbackListPtr *pcbl, void *call_data)
 {
-    if (!pcbl || !*pcbl)
+    if (!pcbl || CallbackListIsEmpty(*pcbl))
         return;
     _CallCallbacks(pcbl, call_data);
 }
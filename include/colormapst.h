@@ -82,6 +82,8 @@ typedef struct _CMEntry {
     Bool fShared;
 } Entry;
 
+typedef struct _ColorIndex *ColorIndexPtr;
+
 /* COLORMAPs can be used for either Direct or Pseudo color.  PseudoColor
  * only needs one cell table, we arbitrarily pick red.  We keep track
  * of that table with freeRed, numPixelsRed, and clientPixelsRed */
@@ -106,6 +108,7 @@ typedef struct _ColormapRec {
     Entry *green;
     Entry *blue;
     PrivateRec *devPrivates;
+    ColorIndexPtr index;        /* cells by colour, built on first use */
 } ColormapRec;
 
 #endif                          /* COLORMAP_H */
@@ -27,6 +27,16 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #define DIXGRABS_H 1
 
 struct _GrabParameters;
+struct _GrabIndexEntry;
+
+/* Walks the passive grabs on a window that may match one detail */
+typedef struct _PassiveGrabIter {
+    Bool indexed;
+    GrabPtr next;               /* when walking the whole list */
+    unsigned int detail;
+    const struct _GrabIndexEntry *exact, *exactEnd;
+    const struct _GrabIndexEntry *any, *anyEnd;
+} PassiveGrabIterRec, *PassiveGrabIterPtr;
 
 extern void PrintDeviceGrabInfo(DeviceIntPtr dev);
 extern void UngrabAllDevices(Bool kill_client);
@@ -59,6 +69,12 @@ extern _X_EXPORT int AddPassiveGrabToList(ClientPtr /* client */ ,
 
 extern _X_EXPORT Bool DeletePassiveGrabFromList(GrabPtr /* pMinuendGrab */ );
 
+extern _X_EXPORT GrabPtr FirstPassiveGrab(WindowPtr /* pWin */ ,
+                                          unsigned int /* detail */ ,
+                                          PassiveGrabIterPtr /* iter */ );
+
+extern _X_EXPORT GrabPtr NextPassiveGrab(PassiveGrabIterPtr /* iter */ );
+
 extern Bool GrabIsPointerGrab(GrabPtr grab);
 extern Bool GrabIsKeyboardGrab(GrabPtr grab);
 #endif                          /* DIXGRABS_H */
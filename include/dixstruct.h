@@ -31,6 +31,7 @@ SOFTWARE.
 #include "gc.h"
 #include "pixmap.h"
 #include "privates.h"
+#include "reqstats.h"
 #include <X11/Xmd.h>
 
 /*
@@ -112,6 +113,7 @@ typedef struct _Client {
 #if XTRANS_SEND_FDS
     int req_fds;
 #endif
+    ReqStatsRec reqStats;       /* request accounting, see reqstats.h */
 } ClientRec;
 
 #if XTRANS_SEND_FDS
@@ -160,20 +162,6 @@ CompareTimeStamps(TimeStamp /*a */ ,
 extern _X_EXPORT TimeStamp
 ClientTimeToServerTime(CARD32 /*c */ );
 
-typedef struct _CallbackRec {
-    CallbackProcPtr proc;
-    void *data;
-    Bool deleted;
-    struct _CallbackRec *next;
-} CallbackRec, *CallbackPtr;
-
-typedef struct _CallbackList {
-    int inCallback;
-    Bool deleted;
-    int numDeleted;
-    CallbackPtr list;
-} CallbackListRec;
-
 /* proc vectors */
 
 extern int (*InitialVector[3]) (ClientPtr /*client */ );
@@ -32,6 +32,9 @@
 _X_EXPORT int EventToCore(InternalEvent *event, xEvent **core, int *count);
 _X_EXPORT int EventToXI(InternalEvent *ev, xEvent **xi, int *count);
 _X_EXPORT int EventToXI2(InternalEvent *ev, xEvent **xi);
+_X_EXPORT int BorrowWireEvent(InternalEvent *ev, enum InputLevel level,
+                              xEvent **xi, int *count);
+_X_EXPORT void ReleaseWireEvent(xEvent *xi);
 _X_INTERNAL int GetCoreType(enum EventType type);
 _X_INTERNAL int GetXIType(enum EventType type);
 _X_INTERNAL int GetXI2Type(enum EventType type);
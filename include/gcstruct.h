@@ -286,6 +286,8 @@ typedef struct _GC {
     PixmapPtr pRotatedPixmap;   /* tile/stipple rotated for alignment */
     RegionPtr pCompositeClip;
     /* fExpose & freeCompClip defined above */
+    RegionPtr pSavedClip;       /* composite clip for another drawable */
+    unsigned int savedClipSerial;       /* ... and that drawable's serial */
 } GC;
 
 #endif                          /* GCSTRUCT_H */
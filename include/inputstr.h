@@ -599,6 +599,9 @@ typedef struct _DeviceIntRec {
     int xtest_master_id;
 
     struct _SyncCounter *idle_counter;
+
+    /* inverse of scale_and_transform, for axes missing from an event */
+    struct pixman_f_transform scale_and_transform_inverse;
 } DeviceIntRec;
 
 typedef struct {
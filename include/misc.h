@@ -398,6 +398,12 @@ extern _X_EXPORT void SwapLongs(CARD32 *list, unsigned long count);
 
 extern _X_EXPORT void SwapShorts(short *list, unsigned long count);
 
+extern _X_EXPORT void CopySwapLongs(CARD32 *dst, const CARD32 *src,
+                                    unsigned long count);
+
+extern _X_EXPORT void CopySwapShorts(CARD16 *dst, const CARD16 *src,
+                                     unsigned long count);
+
 extern _X_EXPORT void MakePredeclaredAtoms(void);
 
 extern _X_EXPORT int Ones(unsigned long /*mask */ );
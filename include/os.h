@@ -98,6 +98,19 @@ extern _X_EXPORT int WaitForSomething(int *     /*pClientsReady */
 
 extern _X_EXPORT int ReadRequestFromClient(ClientPtr /*client */ );
 
+typedef struct _ClientBufferStats {
+    unsigned int input;         /* bytes in the current input buffer */
+    unsigned int output;        /* bytes in the current output buffer */
+    unsigned int peak;          /* most bytes held at once */
+    unsigned int allocs;        /* buffers taken from the pool */
+} ClientBufferStatsRec, *ClientBufferStatsPtr;
+
+extern _X_EXPORT void GetClientBufferStats(ClientPtr /*client */ ,
+                                           ClientBufferStatsPtr /*stats */ );
+
+extern _X_EXPORT void GetBufferPoolStats(unsigned int * /*buffers */ ,
+                                         unsigned int * /*bytes */ );
+
 #if XTRANS_SEND_FDS
 extern _X_EXPORT int ReadFdFromClient(ClientPtr client);
 
@@ -119,6 +132,11 @@ extern _X_EXPORT void SetCriticalOutputPending(void);
 extern _X_EXPORT int WriteToClient(ClientPtr /*who */ , int /*count */ ,
                                    const void * /*buf */ );
 
+extern _X_EXPORT int WriteOwnedToClient(ClientPtr /*who */ , int /*count */ ,
+                                        const void * /*buf */ ,
+                                        void * /*block */ ,
+                                        int /*blockSize */ );
+
 extern _X_EXPORT void ResetOsBuffers(void);
 
 extern _X_EXPORT void InitConnectionLimits(void);
@@ -595,7 +613,8 @@ typedef enum _LogParameter {
     XLOG_FLUSH,
     XLOG_SYNC,
     XLOG_VERBOSITY,
-    XLOG_FILE_VERBOSITY
+    XLOG_FILE_VERBOSITY,
+    XLOG_ASYNC
 } LogParameter;
 
 /* Flags for log messages. */
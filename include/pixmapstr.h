@@ -85,6 +85,7 @@ typedef struct _Pixmap {
     unsigned usage_hint;        /* see CREATE_PIXMAP_USAGE_* */
 
     PixmapPtr master_pixmap;    /* pointer to master copy of pixmap for pixmap sharing */
+    Bool cached;                /* allocated through the screen's pixmap cache */
 } PixmapRec;
 
 typedef struct _PixmapDirtyUpdate {
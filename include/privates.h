@@ -261,6 +261,43 @@ _dixAllocateScreenObjectWithPrivates(ScreenPtr pScreen,
 
 #define dixAllocateScreenObjectWithPrivates(s, t, type) _dixAllocateScreenObjectWithPrivates(s, sizeof(t), sizeof(t), offsetof(t, devPrivates), type)
 
+extern _X_EXPORT void
+_dixFreeScreenObjectWithPrivates(ScreenPtr pScreen, void *object,
+                                 unsigned size, PrivatePtr privates,
+                                 DevPrivateType type);
+
+#define dixFreeScreenObjectWithPrivates(s, o, t) _dixFreeScreenObjectWithPrivates(s, o, sizeof(*(o)), (o)->devPrivates, t)
+
+/*
+ * Windows, GCs and pixmap headers are created and destroyed at high
+ * rates, so each screen keeps a few freed ones of each type for reuse.
+ * Objects come from malloc either way, so freeing a cached object
+ * with free() is harmless; it just isn't recycled.
+ */
+extern _X_EXPORT void *
+dixAllocateCachedObject(ScreenPtr pScreen, DevPrivateType type,
+                        unsigned size);
+
+extern _X_EXPORT void
+dixFreeCachedObject(ScreenPtr pScreen, DevPrivateType type, void *object,
+                    unsigned size);
+
+typedef struct _ObjectCacheStats {
+    const char *name;
+    int cached;
+    unsigned size;
+    unsigned long allocs;
+    unsigned long reused;
+} ObjectCacheStatsRec, *ObjectCacheStatsPtr;
+
+/*
+ * Report the object cache of type on pScreen.  Returns FALSE for types
+ * which are not cached.
+ */
+extern _X_EXPORT Bool
+dixGetObjectCacheStats(ScreenPtr pScreen, DevPrivateType type,
+                       ObjectCacheStatsPtr stats);
+
 extern _X_EXPORT int
 dixScreenSpecificPrivatesSize(ScreenPtr pScreen, DevPrivateType type);
 
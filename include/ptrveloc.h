@@ -54,10 +54,12 @@ typedef double (*PointerAccelerationProfileFunc)
 /**
  * a motion history, with just enough information to
  * calc mean velocity and decide which motion was along
- * a more or less straight line
+ * a more or less straight line.
+ * Trackers form a ring, each remembering the summed motion of the device
+ * when it was started, so that new motion only touches the newest one.
  */
 typedef struct _MotionTracker {
-    double dx, dy;              /* accumulated delta for each axis */
+    double dx, dy;              /* summed motion at creation */
     int time;                   /* time of creation */
     int dir;                    /* initial direction bitfield */
 } MotionTracker, *MotionTrackerPtr;
@@ -88,6 +90,7 @@ typedef struct _DeviceVelocityRec {
     struct {                    /* to be able to query this information */
         int profile_number;
     } statistics;
+    double sum_x, sum_y;        /* motion summed up for the trackers */
 } DeviceVelocityRec, *DeviceVelocityPtr;
 
 /**
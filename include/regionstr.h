@@ -247,6 +247,47 @@ extern _X_EXPORT Bool RegionAppend(RegionPtr /*dstrgn */ ,
 extern _X_EXPORT Bool RegionValidate(RegionPtr /*badreg */ ,
                                      Bool * /*pOverlap */ );
 
+/*
+ * A region builder collects boxes in any order and turns them into a region
+ * in a single sort and sweep, rather than with one RegionUnion per box.
+ */
+typedef struct _RegionBuilder {
+    BoxPtr boxes;
+    int numBoxes;
+    int size;
+    Bool broken;                /* an allocation failed */
+} RegionBuilderRec, *RegionBuilderPtr;
+
+static inline void
+RegionBuilderInit(RegionBuilderPtr builder)
+{
+    builder->boxes = NULL;
+    builder->numBoxes = 0;
+    builder->size = 0;
+    builder->broken = FALSE;
+}
+
+extern _X_EXPORT Bool RegionBuilderAddBoxes(RegionBuilderPtr /*builder */ ,
+                                            const BoxRec * /*boxes */ ,
+                                            int /*nBoxes */ );
+
+static inline Bool
+RegionBuilderAddBox(RegionBuilderPtr builder, const BoxRec *box)
+{
+    if (builder->numBoxes == builder->size)
+        return RegionBuilderAddBoxes(builder, box, 1);
+    builder->boxes[builder->numBoxes++] = *box;
+    return TRUE;
+}
+
+extern _X_EXPORT Bool RegionBuilderAddRegion(RegionBuilderPtr /*builder */ ,
+                                             RegionPtr /*pReg */ );
+
+extern _X_EXPORT Bool RegionBuilderFinish(RegionBuilderPtr /*builder */ ,
+                                          RegionPtr /*pReg */ );
+
+extern _X_EXPORT void RegionBuilderUninit(RegionBuilderPtr /*builder */ );
+
 extern _X_EXPORT RegionPtr RegionFromRects(int /*nrects */ ,
                                            xRectanglePtr /*prect */ ,
                                            int /*ctype */ );
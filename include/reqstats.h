@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifndef REQSTATS_H
+#define REQSTATS_H
+
+#include "misc.h"
+#include "dix.h"
+
+/*
+ * Per-client and per-opcode request accounting, collected in Dispatch()
+ * and reported through the X-Resource extension.  Times are in
+ * microseconds.  Request byte counts include padding, output byte counts
+ * are what was passed to WriteToClient(), without padding.
+ */
+typedef struct _ReqStats {
+    CARD64 count;               /* requests processed */
+    CARD64 time;                /* total time spent in request handlers */
+    CARD64 bytes_in;            /* request bytes read */
+    CARD64 bytes_out;           /* reply, event and error bytes written */
+    CARD32 max_time;            /* slowest single request */
+} ReqStatsRec, *ReqStatsPtr;
+
+typedef void (*ReqStatsProcPtr) (int /* major */ ,
+                                 int /* minor */ ,
+                                 ReqStatsPtr /* stats */ ,
+                                 void * /* closure */ );
+
+extern _X_EXPORT Bool ReqStatsEnabled;
+
+/* Bumped by ReqStatsReset(), so that a request spanning a reset is not
+ * charged for output counted before it */
+extern unsigned long ReqStatsResets;
+
+extern void
+ReqStatsAccount(ClientPtr /* client */ ,
+                int /* major */ ,
+                int /* minor */ ,
+                CARD32 /* bytes_in */ ,
+                CARD32 /* bytes_out */ ,
+                CARD32 /* elapsed */ );
+
+extern _X_EXPORT void
+ReqStatsForEach(ReqStatsProcPtr /* proc */ ,
+                void * /* closure */ );
+
+extern _X_EXPORT void
+ReqStatsReset(void);
+
+extern void
+ReqStatsFree(void);
+
+#endif                          /* REQSTATS_H */
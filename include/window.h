@@ -71,6 +71,7 @@ struct _Cursor;
 
 typedef struct _BackingStore *BackingStorePtr;
 typedef struct _Window *WindowPtr;
+typedef struct _ChildIndex *ChildIndexPtr;
 
 enum RootClipMode {
     ROOT_CLIP_NONE = 0, /**< resize the root window to 0x0 */
@@ -232,4 +233,22 @@ extern _X_EXPORT void PrintWindowTree(void);
 extern _X_EXPORT void PrintPassiveGrabs(void);
 
 extern _X_EXPORT VisualPtr WindowGetVisual(WindowPtr /*pWin*/);
+
+/* winindex.c */
+
+extern _X_EXPORT void FreeChildIndex(WindowPtr /* pWin */ );
+
+extern _X_EXPORT void ChildIndexStackChanged(WindowPtr /* pParent */ );
+
+extern _X_EXPORT void ChildIndexGeometryChanged(WindowPtr /* pWin */ );
+
+extern _X_EXPORT WindowPtr *ChildIndexAtPoint(WindowPtr /* pParent */ ,
+                                              int /* x */ ,
+                                              int /* y */ ,
+                                              int * /* count */ );
+
+extern _X_EXPORT WindowPtr *ChildIndexInBox(WindowPtr /* pParent */ ,
+                                            BoxPtr /* box */ ,
+                                            WindowPtr /* pFirst */ ,
+                                            int * /* count */ );
 #endif                          /* WINDOW_H */
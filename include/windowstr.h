@@ -93,6 +93,9 @@ typedef struct _WindowOpt {
     RegionPtr inputShape;       /* default: NULL */
     struct _OtherInputMasks *inputMasks;        /* default: NULL */
     DevCursorList deviceCursors;        /* default: NULL */
+    struct _PropertyIndex *propIndex;   /* default: NULL */
+    struct _EventInterest *eventInterest;       /* default: NULL */
+    struct _GrabIndex *grabIndex;       /* default: NULL */
 } WindowOptRec, *WindowOptPtr;
 
 #define BackgroundPixel	    2L
@@ -167,6 +170,8 @@ typedef struct _Window {
     unsigned damagedDescendants:1;      /* some descendants are damaged */
     unsigned inhibitBGPaint:1;  /* paint the background? */
 #endif
+    ChildIndexPtr childIndex;   /* spatial index of many children */
+    int childRank;              /* stacking position in parent's index */
 } WindowRec;
 
 /*
@@ -189,6 +194,7 @@ extern _X_EXPORT Mask DontPropagateMasks[];
 #define wDontPropagateMask(w)	wUseDefault(w, dontPropagateMask, DontPropagateMasks[(w)->dontPropagate])
 #define wOtherEventMasks(w)	wUseDefault(w, otherEventMasks, 0)
 #define wOtherClients(w)	wUseDefault(w, otherClients, NULL)
+#define wEventInterest(w)	wUseDefault(w, eventInterest, NULL)
 #define wOtherInputMasks(w)	wUseDefault(w, inputMasks, NULL)
 #define wPassiveGrabs(w)	wUseDefault(w, passiveGrabs, NULL)
 #define wUserProps(w)		wUseDefault(w, userProps, NULL)
@@ -53,6 +53,7 @@ in this Software without prior written authorization from The Open Group.
 #include   "extinit.h"
 #include   "exglobals.h"
 #include   "eventstr.h"
+#include   "probes.h"
 
 #ifdef DPMSExtension
 #include "dpmsproc.h"
@@ -637,6 +638,12 @@ mieqProcessInputEvents(void)
             DPMSSet(serverClient, DPMSModeOn);
 #endif
 
+#ifdef XSERVER_SDT
+        if (XSERVER_INPUT_PROCESS_ENABLED())
+            XSERVER_INPUT_PROCESS(dev ? dev->id : -1, event.any.type,
+                                  event.any.time);
+#endif
+
         mieqProcessDeviceEvent(dev, &event, screen);
 
         /* Update the sprite now. Next event may be from different device. */
@@ -50,6 +50,8 @@ miDestroyGC(GCPtr pGC)
         (*pGC->pScreen->DestroyPixmap) (pGC->pRotatedPixmap);
     if (pGC->freeCompClip)
         RegionDestroy(pGC->pCompositeClip);
+    if (pGC->pSavedClip)
+        RegionDestroy(pGC->pSavedClip);
 }
 
 void
@@ -203,3 +205,59 @@ miComputeCompositeClip(GCPtr pGC, DrawablePtr pDrawable)
         }
     }                           /* end of composite clip for pixmap */
 }                               /* end miComputeCompositeClip */
+
+static void
+miFreeSavedClip(GCPtr pGC)
+{
+    if (pGC->pSavedClip)
+        RegionDestroy(pGC->pSavedClip);
+    pGC->pSavedClip = NULL;
+}
+
+/*
+ * Bring the composite clip up to date for ValidateGC, recomputing it
+ * only when the client clip, the subwindow mode or the drawable changed.
+ * A GC alternating between two drawables keeps the composite clip it
+ * computed for the other one, and swaps it back in when that drawable
+ * has not changed in the meantime.  Only clips which took real work to
+ * compute, and so belong to the GC, are kept; the clip list of a window
+ * is just pointed at.
+ */
+void
+miValidateCompositeClip(GCPtr pGC, unsigned long changes,
+                        DrawablePtr pDrawable)
+{
+    unsigned int serial = pGC->serialNumber & DRAWABLE_SERIAL_BITS;
+
+    if (changes &
+        (GCClipXOrigin | GCClipYOrigin | GCClipMask | GCSubwindowMode)) {
+        miFreeSavedClip(pGC);
+        miComputeCompositeClip(pGC, pDrawable);
+        return;
+    }
+    if (pDrawable->serialNumber == serial)
+        return;
+
+    if (pGC->pSavedClip && pGC->savedClipSerial == pDrawable->serialNumber) {
+        RegionPtr pClip = pGC->pSavedClip;
+
+        if (pGC->freeCompClip) {
+            pGC->pSavedClip = pGC->pCompositeClip;
+            pGC->savedClipSerial = serial;
+        }
+        else
+            pGC->pSavedClip = NULL;
+        pGC->pCompositeClip = pClip;
+        pGC->freeCompClip = TRUE;
+        return;
+    }
+
+    if (pGC->freeCompClip && serial) {
+        miFreeSavedClip(pGC);
+        pGC->pSavedClip = pGC->pCompositeClip;
+        pGC->savedClipSerial = serial;
+        pGC->pCompositeClip = NULL;
+        pGC->freeCompClip = FALSE;
+    }
+    miComputeCompositeClip(pGC, pDrawable);
+}
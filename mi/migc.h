@@ -47,3 +47,7 @@ extern _X_EXPORT void miCopyGC(GCPtr            pGCSrc,
 
 extern _X_EXPORT void miComputeCompositeClip(GCPtr              pGC,
                                              DrawablePtr        pDrawable);
+
+extern _X_EXPORT void miValidateCompositeClip(GCPtr             pGC,
+                                              unsigned long     changes,
+                                              DrawablePtr       pDrawable);
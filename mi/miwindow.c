@@ -132,11 +132,43 @@ miMarkWindow(WindowPtr pWin)
     pWin->valdata = val;
 }
 
+/* Mark pTop and those of its inferiors which overlap box */
+static Bool
+miMarkOverlappedSubtree(WindowPtr pTop, BoxPtr box,
+                        MarkWindowProcPtr MarkWindow)
+{
+    WindowPtr pChild = pTop;
+    Bool anyMarked = FALSE;
+
+    while (1) {
+        if (pChild->viewable) {
+            if (RegionBroken(&pChild->winSize))
+                SetWinSize(pChild);
+            if (RegionBroken(&pChild->borderSize))
+                SetBorderSize(pChild);
+            if (RegionContainsRect(&pChild->borderSize, box)) {
+                (*MarkWindow) (pChild);
+                anyMarked = TRUE;
+                if (pChild->firstChild) {
+                    pChild = pChild->firstChild;
+                    continue;
+                }
+            }
+        }
+        while (!pChild->nextSib && (pChild != pTop))
+            pChild = pChild->parent;
+        if (pChild == pTop)
+            break;
+        pChild = pChild->nextSib;
+    }
+    return anyMarked;
+}
+
 Bool
 miMarkOverlappedWindows(WindowPtr pWin, WindowPtr pFirst, WindowPtr *ppLayerWin)
 {
     BoxPtr box;
-    WindowPtr pChild, pLast;
+    WindowPtr pChild;
     Bool anyMarked = FALSE;
     MarkWindowProcPtr MarkWindow = pWin->drawable.pScreen->MarkWindow;
 
@@ -171,29 +203,20 @@ miMarkOverlappedWindows(WindowPtr pWin, WindowPtr pFirst, WindowPtr *ppLayerWin)
         anyMarked = TRUE;
         pFirst = pFirst->nextSib;
     }
-    if ((pChild = pFirst)) {
+    if (pFirst) {
+        WindowPtr *candidates;
+        int i, count;
+
         box = RegionExtents(&pWin->borderSize);
-        pLast = pChild->parent->lastChild;
-        while (1) {
-            if (pChild->viewable) {
-                if (RegionBroken(&pChild->winSize))
-                    SetWinSize(pChild);
-                if (RegionBroken(&pChild->borderSize))
-                    SetBorderSize(pChild);
-                if (RegionContainsRect(&pChild->borderSize, box)) {
-                    (*MarkWindow) (pChild);
-                    anyMarked = TRUE;
-                    if (pChild->firstChild) {
-                        pChild = pChild->firstChild;
-                        continue;
-                    }
-                }
-            }
-            while (!pChild->nextSib && (pChild != pLast))
-                pChild = pChild->parent;
-            if (pChild == pLast)
-                break;
-            pChild = pChild->nextSib;
+        candidates = ChildIndexInBox(pFirst->parent, box, pFirst, &count);
+        if (candidates) {
+            for (i = 0; i < count; i++)
+                anyMarked |= miMarkOverlappedSubtree(candidates[i], box,
+                                                     MarkWindow);
+        }
+        else {
+            for (pChild = pFirst; pChild; pChild = pChild->nextSib)
+                anyMarked |= miMarkOverlappedSubtree(pChild, box, MarkWindow);
         }
     }
     if (anyMarked)
@@ -289,13 +312,19 @@ miMoveWindow(WindowPtr pWin, int x, int y, WindowPtr pNextSib, VTKind kind)
                 (pWin, pLayerWin, NULL);
 
         if (anyMarked) {
-            (*pScreen->ValidateTree) (pLayerWin->parent, NullWindow, kind);
+            /* Siblings above the first change were neither moved nor
+             * marked, so there is no need to validate them */
+            WindowPtr pFirstChange =
+                (pLayerWin == pWin) ? windowToValidate : pLayerWin;
+
+            (*pScreen->ValidateTree) (pLayerWin->parent, pFirstChange, kind);
             (*pWin->drawable.pScreen->CopyWindow) (pWin, oldpt, oldRegion);
             RegionDestroy(oldRegion);
             /* XXX need to retile border if ParentRelative origin */
             (*pScreen->HandleExposures) (pLayerWin->parent);
             if (pScreen->PostValidateTree)
-                (*pScreen->PostValidateTree) (pLayerWin->parent, NULL, kind);
+                (*pScreen->PostValidateTree) (pLayerWin->parent, pFirstChange,
+                                              kind);
         }
     }
     if (pWin->realized)
@@ -745,46 +774,69 @@ miMarkUnrealizedWindow(WindowPtr pChild, WindowPtr pWin, Bool fromConfigure)
     }
 }
 
+/* Whether x, y hits pWin for the purpose of pointer picking */
+static Bool
+miSpriteHitsWindow(WindowPtr pWin, int x, int y)
+{
+    BoxRec box;
+
+    return (pWin->mapped) &&
+        (x >= pWin->drawable.x - wBorderWidth(pWin)) &&
+        (x < pWin->drawable.x + (int) pWin->drawable.width +
+         wBorderWidth(pWin)) &&
+        (y >= pWin->drawable.y - wBorderWidth(pWin)) &&
+        (y < pWin->drawable.y + (int) pWin->drawable.height +
+         wBorderWidth(pWin))
+        /* When a window is shaped, a further check
+         * is made to see if the point is inside
+         * borderSize
+         */
+        && (!wBoundingShape(pWin) || PointInBorderSize(pWin, x, y))
+        && (!wInputShape(pWin) ||
+            RegionContainsPoint(wInputShape(pWin),
+                                x - pWin->drawable.x,
+                                y - pWin->drawable.y, &box))
+        /* In rootless mode windows may be offscreen, even when
+         * they're in X's stack. (E.g. if the native window system
+         * implements some form of virtual desktop system).
+         */
+        && !pWin->unhittable;
+}
+
+/* The topmost child of pParent hit by x, y, if any */
+static WindowPtr
+miSpriteHitChild(WindowPtr pParent, int x, int y)
+{
+    WindowPtr *candidates, pWin;
+    int i, count;
+
+    candidates = ChildIndexAtPoint(pParent, x, y, &count);
+    if (candidates) {
+        for (i = 0; i < count; i++)
+            if (miSpriteHitsWindow(candidates[i], x, y))
+                return candidates[i];
+        return NullWindow;
+    }
+
+    for (pWin = pParent->firstChild; pWin; pWin = pWin->nextSib)
+        if (miSpriteHitsWindow(pWin, x, y))
+            return pWin;
+    return NullWindow;
+}
+
 WindowPtr
 miSpriteTrace(SpritePtr pSprite, int x, int y)
 {
     WindowPtr pWin;
-    BoxRec box;
 
-    pWin = DeepestSpriteWin(pSprite)->firstChild;
-    while (pWin) {
-        if ((pWin->mapped) &&
-            (x >= pWin->drawable.x - wBorderWidth(pWin)) &&
-            (x < pWin->drawable.x + (int) pWin->drawable.width +
-             wBorderWidth(pWin)) &&
-            (y >= pWin->drawable.y - wBorderWidth(pWin)) &&
-            (y < pWin->drawable.y + (int) pWin->drawable.height +
-             wBorderWidth(pWin))
-            /* When a window is shaped, a further check
-             * is made to see if the point is inside
-             * borderSize
-             */
-            && (!wBoundingShape(pWin) || PointInBorderSize(pWin, x, y))
-            && (!wInputShape(pWin) ||
-                RegionContainsPoint(wInputShape(pWin),
-                                    x - pWin->drawable.x,
-                                    y - pWin->drawable.y, &box))
-            /* In rootless mode windows may be offscreen, even when
-             * they're in X's stack. (E.g. if the native window system
-             * implements some form of virtual desktop system).
-             */
-            && !pWin->unhittable) {
-            if (pSprite->spriteTraceGood >= pSprite->spriteTraceSize) {
-                pSprite->spriteTraceSize += 10;
-                pSprite->spriteTrace = reallocarray(pSprite->spriteTrace,
-                                                    pSprite->spriteTraceSize,
-                                                    sizeof(WindowPtr));
-            }
-            pSprite->spriteTrace[pSprite->spriteTraceGood++] = pWin;
-            pWin = pWin->firstChild;
+    while ((pWin = miSpriteHitChild(DeepestSpriteWin(pSprite), x, y))) {
+        if (pSprite->spriteTraceGood >= pSprite->spriteTraceSize) {
+            pSprite->spriteTraceSize += 10;
+            pSprite->spriteTrace = reallocarray(pSprite->spriteTrace,
+                                                pSprite->spriteTraceSize,
+                                                sizeof(WindowPtr));
         }
-        else
-            pWin = pWin->nextSib;
+        pSprite->spriteTrace[pSprite->spriteTraceGood++] = pWin;
     }
     return DeepestSpriteWin(pSprite);
 }
@@ -39,6 +39,7 @@
 #include    "gcstruct.h"
 #include    "damage.h"
 #include    "damagestr.h"
+#include    "probes.h"
 
 #define wrap(priv, real, mem, func) {\
     priv->mem = real->mem; \
@@ -149,6 +150,16 @@ damageRegionAppend(DrawablePtr pDrawable, RegionPtr pRegion, Bool clip,
     if (!RegionNotEmpty(pRegion))
         return;
 
+#ifdef XSERVER_SDT
+    if (XSERVER_DAMAGE_APPEND_ENABLED()) {
+        BoxPtr extents = RegionExtents(pRegion);
+
+        XSERVER_DAMAGE_APPEND(pDrawable->id, RegionNumRects(pRegion),
+                              extents->x1, extents->y1,
+                              extents->x2, extents->y2);
+    }
+#endif
+
 #ifdef COMPOSITE
     /*
      * When drawing to a pixmap which is storing window contents,
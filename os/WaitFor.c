@@ -73,6 +73,7 @@ SOFTWARE.
 #include "dpmsproc.h"
 #endif
 #include "busfault.h"
+#include "probes.h"
 
 #ifdef WIN32
 /* Error codes from windows sockets differ from fileio error codes  */
@@ -227,6 +228,10 @@ WaitForSomething(int *pClientsReady)
             i = Select(MaxClients, &LastSelectMask, NULL, NULL, wt);
         }
         selecterr = GetErrno();
+#ifdef XSERVER_DTRACE
+        if (XSERVER_WAIT_WAKEUP_ENABLED())
+            XSERVER_WAIT_WAKEUP(i, i < 0 ? selecterr : 0);
+#endif
         WakeupHandler(i, (void *) &LastSelectMask);
         if (i <= 0) {           /* An error or timeout occurred */
             if (dispatchException)
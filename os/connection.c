@@ -770,6 +770,8 @@ AllocNewConnection(XtransConnInfo trans_conn, int fd, CARD32 conn_time)
     oc->output = (ConnectionOutputPtr) NULL;
     oc->auth_id = None;
     oc->conn_time = conn_time;
+    oc->buffer_peak = 0;
+    oc->buffer_allocs = 0;
     if (!(client = NextAvailableClient((void *) oc))) {
         free(oc);
         return NullClient;
@@ -1045,8 +1047,7 @@ CloseDownConnection(ClientPtr client)
 {
     OsCommPtr oc = (OsCommPtr) client->osPrivate;
 
-    if (FlushCallback)
-        CallCallbacks(&FlushCallback, NULL);
+    CallCallbacks(&FlushCallback, NULL);
 
     if (oc->output)
 	FlushClient(client, oc, (char *) NULL, 0);
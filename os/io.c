@@ -97,10 +97,23 @@ typedef struct _connectionOutput {
     unsigned char *buf;
     int size;
     int count;
+    void *owned;                /* malloc()ed block buf points into, if
+                                   it was handed over by the caller */
 } ConnectionOutput;
 
 static ConnectionInputPtr AllocateInputBuffer(void);
 static ConnectionOutputPtr AllocateOutputBuffer(void);
+static void FreeInputBuffer(ConnectionInputPtr oci);
+static void FreeOutputBuffer(ConnectionOutputPtr oco);
+static void FreeOutputData(ConnectionOutputPtr oco);
+static Bool ResizeOutputBuffer(ConnectionOutputPtr oco, int newsize);
+static int WriteToClientBlock(ClientPtr who, int count, const void *__buf,
+                              void *block, int blockSize);
+static int FlushClientBlock(ClientPtr who, OsCommPtr oc,
+                            const void *__extraBuf, int extraCount,
+                            void *block, int blockSize);
+static void *ResizeBuffer(void *buf, int *size, int newsize, int used);
+static void NoteBufferUsage(OsCommPtr oc);
 
 /* If EAGAIN and EWOULDBLOCK are distinct errno values, then we check errno
  * for both EAGAIN and EWOULDBLOCK, because some supposedly POSIX
@@ -126,6 +139,7 @@ static OsCommPtr AvailableInput = (OsCommPtr) NULL;
 			      lswaps((req)->length) : (req)->length)
 
 #include <X11/extensions/bigreqsproto.h>
+#include "probes.h"
 
 #define get_big_req_len(req,cli) ((cli)->swapped ? \
 				  lswapl(((xBigReq *)(req))->length) : \
@@ -135,6 +149,32 @@ static OsCommPtr AvailableInput = (OsCommPtr) NULL;
 #define BUFSIZE 4096
 #define BUFWATERMARK 8192
 
+/*
+ * Buffers come from a pool of power-of-two size classes, BUFSIZE up to
+ * BUFSIZE << (BUF_CLASSES - 1).  Each class has its own free list, so that
+ * clients alternating between large and small traffic trade buffers with
+ * the pool instead of growing and shrinking them with realloc.  Free
+ * buffers that were not needed during the last BUF_TRIM_INTERVAL are
+ * released the next time a buffer is returned.  Larger buffers are
+ * allocated exactly and never pooled.
+ */
+#define BUF_CLASSES 7
+#define BUF_POOL_MAX 64                 /* free buffers kept per class */
+#define BUF_POOL_BYTES (1024 * 1024)    /* free bytes kept per class */
+#define BUF_TRIM_INTERVAL 10000         /* ms */
+
+typedef struct _poolBuffer {
+    struct _poolBuffer *next;
+} PoolBufferRec, *PoolBufferPtr;
+
+static struct {
+    PoolBufferPtr free;
+    int nfree;
+    int lowfree;                /* fewest free buffers since the last trim */
+} bufferPool[BUF_CLASSES];
+
+static CARD32 bufferPoolTrimTime;
+
 /*
  *   A lot of the code in this file manipulates a ConnectionInputPtr:
  *
@@ -211,26 +251,16 @@ YieldControlDeath(void)
     timesThisConnection = 0;
 }
 
-/* If an input buffer was empty, either free it if it is too big or link it
- * into our list of free input buffers.  This means that different clients can
- * share the same input buffer (at different times).  This was done to save
- * memory.
+/* If an input buffer was empty, return it to the buffer pool.  This means
+ * that different clients can share the same input buffer (at different
+ * times).  This was done to save memory.
  */
 static void
 NextAvailableInput(OsCommPtr oc)
 {
     if (AvailableInput) {
         if (AvailableInput != oc) {
-            ConnectionInputPtr aci = AvailableInput->input;
-
-            if (aci->size > BUFWATERMARK) {
-                free(aci->buffer);
-                free(aci);
-            }
-            else {
-                aci->next = FreeInputs;
-                FreeInputs = aci;
-            }
+            FreeInputBuffer(AvailableInput->input);
             AvailableInput->input = NULL;
         }
         AvailableInput = NULL;
@@ -254,14 +284,12 @@ ReadRequestFromClient(ClientPtr client)
     /* make sure we have an input buffer */
 
     if (!oci) {
-        if ((oci = FreeInputs)) {
-            FreeInputs = oci->next;
-        }
-        else if (!(oci = AllocateInputBuffer())) {
+        if (!(oci = AllocateInputBuffer())) {
             YieldControlDeath();
             return -1;
         }
         oc->input = oci;
+        NoteBufferUsage(oc);
     }
 
 #if XTRANS_SEND_FDS
@@ -341,13 +369,13 @@ ReadRequestFromClient(ClientPtr client)
                 /* make buffer bigger to accomodate request */
                 char *ibuf;
 
-                ibuf = (char *) realloc(oci->buffer, needed);
+                ibuf = ResizeBuffer(oci->buffer, &oci->size, needed, gotnow);
                 if (!ibuf) {
                     YieldControlDeath();
                     return -1;
                 }
-                oci->size = needed;
                 oci->buffer = ibuf;
+                NoteBufferUsage(oc);
             }
             oci->bufptr = oci->buffer;
             oci->bufcnt = gotnow;
@@ -386,9 +414,9 @@ ReadRequestFromClient(ClientPtr client)
             (oci->bufcnt < BUFSIZE) && (needed < BUFSIZE)) {
             char *ibuf;
 
-            ibuf = (char *) realloc(oci->buffer, BUFSIZE);
+            ibuf = ResizeBuffer(oci->buffer, &oci->size, BUFSIZE,
+                                oci->bufcnt);
             if (ibuf) {
-                oci->size = BUFSIZE;
                 oci->buffer = ibuf;
                 oci->bufptr = ibuf + oci->bufcnt - gotnow;
             }
@@ -540,11 +568,10 @@ InsertFakeRequest(ClientPtr client, char *data, int count)
     NextAvailableInput(oc);
 
     if (!oci) {
-        if ((oci = FreeInputs))
-            FreeInputs = oci->next;
-        else if (!(oci = AllocateInputBuffer()))
+        if (!(oci = AllocateInputBuffer()))
             return FALSE;
         oc->input = oci;
+        NoteBufferUsage(oc);
     }
     oci->bufptr += oci->lenLastReq;
     oci->lenLastReq = 0;
@@ -552,12 +579,13 @@ InsertFakeRequest(ClientPtr client, char *data, int count)
     if ((gotnow + count) > oci->size) {
         char *ibuf;
 
-        ibuf = (char *) realloc(oci->buffer, gotnow + count);
+        ibuf = ResizeBuffer(oci->buffer, &oci->size, gotnow + count,
+                            oci->bufcnt);
         if (!ibuf)
             return FALSE;
-        oci->size = gotnow + count;
         oci->buffer = ibuf;
         oci->bufptr = ibuf + oci->bufcnt - gotnow;
+        NoteBufferUsage(oc);
     }
     moveup = count - (oci->bufptr - oci->buffer);
     if (moveup > 0) {
@@ -647,8 +675,7 @@ FlushAllOutput(void)
     fd_set newOutputPending;
 #endif
 
-    if (FlushCallback)
-        CallCallbacks(&FlushCallback, NULL);
+    CallCallbacks(&FlushCallback, NULL);
 
     if (!newoutput)
         return;
@@ -731,6 +758,29 @@ SetCriticalOutputPending(void)
 
 int
 WriteToClient(ClientPtr who, int count, const void *__buf)
+{
+    return WriteToClientBlock(who, count, __buf, NULL, 0);
+}
+
+/*****************
+ * WriteOwnedToClient
+ *    Like WriteToClient, but also takes over block, a malloc()ed buffer
+ *    of blockSize bytes that holds the count bytes at buf.  If the client
+ *    cannot take all of them at once, the rest is left in block for later
+ *    rather than copied into the output buffer.  block is freed once it
+ *    has been written, or on error.
+ *****************/
+
+int
+WriteOwnedToClient(ClientPtr who, int count, const void *buf,
+                   void *block, int blockSize)
+{
+    return WriteToClientBlock(who, count, buf, block, blockSize);
+}
+
+static int
+WriteToClientBlock(ClientPtr who, int count, const void *__buf,
+                   void *block, int blockSize)
 {
     OsCommPtr oc;
     ConnectionOutputPtr oco;
@@ -740,10 +790,13 @@ WriteToClient(ClientPtr who, int count, const void *__buf)
 #ifdef DEBUG_COMMUNICATION
     Bool multicount = FALSE;
 #endif
-    if (!count || !who || who == serverClient || who->clientGone)
+    if (!count || !who || who == serverClient || who->clientGone) {
+        free(block);
         return 0;
+    }
     oc = who->osPrivate;
     oco = oc->output;
+    who->reqStats.bytes_out += count;
 #ifdef DEBUG_COMMUNICATION
     {
         char info[128];
@@ -786,24 +839,23 @@ WriteToClient(ClientPtr who, int count, const void *__buf)
 #endif
 
     if (!oco) {
-        if ((oco = FreeOutputs)) {
-            FreeOutputs = oco->next;
-        }
-        else if (!(oco = AllocateOutputBuffer())) {
+        if (!(oco = AllocateOutputBuffer())) {
             if (oc->trans_conn) {
                 _XSERVTransDisconnect(oc->trans_conn);
                 _XSERVTransClose(oc->trans_conn);
                 oc->trans_conn = NULL;
             }
             MarkClientException(who);
+            free(block);
             return -1;
         }
         oc->output = oco;
+        NoteBufferUsage(oc);
     }
 
     padBytes = padding_for_int32(count);
 
-    if (ReplyCallback) {
+    if (!CallbackListIsEmpty(ReplyCallback)) {
         ReplyInfoRec replyinfo;
 
         replyinfo.client = who;
@@ -850,10 +902,9 @@ WriteToClient(ClientPtr who, int count, const void *__buf)
             NewOutputPending = FALSE;
         }
 
-        if (FlushCallback)
-            CallCallbacks(&FlushCallback, NULL);
+        CallCallbacks(&FlushCallback, NULL);
 
-        return FlushClient(who, oc, buf, count);
+        return FlushClientBlock(who, oc, buf, count, block, blockSize);
     }
 
     NewOutputPending = TRUE;
@@ -864,6 +915,7 @@ WriteToClient(ClientPtr who, int count, const void *__buf)
         memset(oco->buf + oco->count, '\0', padBytes);
         oco->count += padBytes;
     }
+    free(block);
     return count;
 }
 
@@ -879,6 +931,14 @@ WriteToClient(ClientPtr who, int count, const void *__buf)
 
 int
 FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
+{
+    return FlushClientBlock(who, oc, __extraBuf, extraCount, NULL, 0);
+}
+
+/* FlushClient, taking over block as WriteOwnedToClient does */
+static int
+FlushClientBlock(ClientPtr who, OsCommPtr oc, const void *__extraBuf,
+                 int extraCount, void *block, int blockSize)
 {
     ConnectionOutputPtr oco = oc->output;
     int connection = oc->fd;
@@ -891,14 +951,21 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
     long notWritten;
     long todo;
 
-    if (!oco)
+    if (!oco) {
+        free(block);
 	return 0;
+    }
     written = 0;
     padsize = padding_for_int32(extraCount);
     notWritten = oco->count + extraCount + padsize;
     if (!notWritten)
         return 0;
 
+#ifdef XSERVER_DTRACE
+    if (XSERVER_FLUSH_CLIENT_ENABLED())
+        XSERVER_FLUSH_CLIENT(who->index, notWritten);
+#endif
+
     todo = notWritten;
     while (notWritten) {
         long before = written;  /* amount of whole thing written */
@@ -960,32 +1027,47 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
             if (written < oco->count) {
                 if (written > 0) {
                     oco->count -= written;
-                    memmove((char *) oco->buf,
-                            (char *) oco->buf + written, oco->count);
+                    if (oco->owned) {
+                        oco->buf += written;
+                        oco->size -= written;
+                    }
+                    else
+                        memmove((char *) oco->buf,
+                                (char *) oco->buf + written, oco->count);
                     written = 0;
                 }
             }
             else {
                 written -= oco->count;
                 oco->count = 0;
+
+                /* Keep the rest of a block we were given, if the pad fits */
+                if (block && written < extraCount &&
+                    extraBuf + extraCount + padsize <=
+                    (char *) block + blockSize) {
+                    FreeOutputData(oco);
+                    oco->owned = block;
+                    oco->buf = (unsigned char *) extraBuf + written;
+                    oco->size = (unsigned char *) block + blockSize - oco->buf;
+                    memset(oco->buf + extraCount - written, '\0', padsize);
+                    oco->count = notWritten;
+                    NoteBufferUsage(oc);
+                    return extraCount;
+                }
             }
 
             if (notWritten > oco->size) {
-                unsigned char *obuf = NULL;
-
-                if (notWritten + BUFSIZE <= INT_MAX) {
-                    obuf = realloc(oco->buf, notWritten + BUFSIZE);
-                }
-                if (!obuf) {
+                if (notWritten + BUFSIZE > INT_MAX ||
+                    !ResizeOutputBuffer(oco, notWritten + BUFSIZE)) {
                     _XSERVTransDisconnect(oc->trans_conn);
                     _XSERVTransClose(oc->trans_conn);
                     oc->trans_conn = NULL;
                     MarkClientException(who);
                     oco->count = 0;
+                    free(block);
                     return -1;
                 }
-                oco->size = notWritten + BUFSIZE;
-                oco->buf = obuf;
+                NoteBufferUsage(oc);
             }
 
             /* If the amount written extended into the padBuffer, then the
@@ -995,6 +1077,7 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
                         extraBuf + written, len);
 
             oco->count = notWritten;    /* this will include the pad */
+            free(block);
             /* return only the amount explicitly requested */
             return extraCount;
         }
@@ -1011,6 +1094,7 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
             }
             MarkClientException(who);
             oco->count = 0;
+            free(block);
             return -1;
         }
     }
@@ -1023,16 +1107,176 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
         if (!XFD_ANYSET(&ClientsWriteBlocked))
             AnyClientsWriteBlocked = FALSE;
     }
-    if (oco->size > BUFWATERMARK) {
-        free(oco->buf);
-        free(oco);
+    FreeOutputBuffer(oco);
+    oc->output = (ConnectionOutputPtr) NULL;
+    free(block);
+    return extraCount;          /* return only the amount explicitly requested */
+}
+
+static int
+BufferClass(int size)
+{
+    int class = 0;
+
+    while (class < BUF_CLASSES && (BUFSIZE << class) < size)
+        class++;
+    return class;
+}
+
+static void
+BufferPoolTrim(void)
+{
+    CARD32 now = GetTimeInMillis();
+    int class;
+
+    if ((int) (now - bufferPoolTrimTime) < BUF_TRIM_INTERVAL)
+        return;
+    bufferPoolTrimTime = now;
+
+    for (class = 0; class < BUF_CLASSES; class++) {
+        /* Free the buffers nobody needed since the last trim */
+        while (bufferPool[class].lowfree > 0) {
+            PoolBufferPtr pb = bufferPool[class].free;
+
+            bufferPool[class].free = pb->next;
+            bufferPool[class].nfree--;
+            bufferPool[class].lowfree--;
+            free(pb);
+        }
+        bufferPool[class].lowfree = bufferPool[class].nfree;
+    }
+}
+
+/* Allocate a buffer of at least *size bytes, and return its real size */
+static void *
+AllocateBuffer(int *size)
+{
+    int class = BufferClass(*size);
+    PoolBufferPtr pb;
+
+    if (class == BUF_CLASSES)
+        return malloc(*size);
+
+    *size = BUFSIZE << class;
+    if (!(pb = bufferPool[class].free))
+        return malloc(*size);
+
+    bufferPool[class].free = pb->next;
+    if (--bufferPool[class].nfree < bufferPool[class].lowfree)
+        bufferPool[class].lowfree = bufferPool[class].nfree;
+    return pb;
+}
+
+static void
+FreeBuffer(void *buf, int size)
+{
+    int class = BufferClass(size);
+    PoolBufferPtr pb = buf;
+
+    if (!buf)
+        return;
+
+    if (class == BUF_CLASSES || (BUFSIZE << class) != size ||
+        bufferPool[class].nfree >= BUF_POOL_MAX ||
+        bufferPool[class].nfree * size >= BUF_POOL_BYTES) {
+        free(buf);
     }
     else {
-        oco->next = FreeOutputs;
-        FreeOutputs = oco;
+        pb->next = bufferPool[class].free;
+        bufferPool[class].free = pb;
+        bufferPool[class].nfree++;
+    }
+
+    BufferPoolTrim();
+}
+
+/*
+ * Replace buf by a buffer of at least newsize bytes, keeping its first
+ * used bytes.  On failure, buf is left alone and NULL returned.
+ */
+static void *
+ResizeBuffer(void *buf, int *size, int newsize, int used)
+{
+    void *nbuf = AllocateBuffer(&newsize);
+
+    if (!nbuf)
+        return NULL;
+    if (used)
+        memcpy(nbuf, buf, used);
+    FreeBuffer(buf, *size);
+    *size = newsize;
+    return nbuf;
+}
+
+/*
+ * Replace the output buffer by one of at least newsize bytes, keeping its
+ * contents.  On failure, the old buffer is left alone.
+ */
+static Bool
+ResizeOutputBuffer(ConnectionOutputPtr oco, int newsize)
+{
+    unsigned char *obuf;
+
+    if (!oco->owned) {
+        obuf = ResizeBuffer(oco->buf, &oco->size, newsize, oco->count);
+        if (!obuf)
+            return FALSE;
+    }
+    else {
+        obuf = AllocateBuffer(&newsize);
+        if (!obuf)
+            return FALSE;
+        memcpy(obuf, oco->buf, oco->count);
+        free(oco->owned);
+        oco->owned = NULL;
+        oco->size = newsize;
+    }
+    oco->buf = obuf;
+    return TRUE;
+}
+
+/* Track the most buffer memory each client held at once */
+static void
+NoteBufferUsage(OsCommPtr oc)
+{
+    unsigned int used = 0;
+
+    if (oc->input)
+        used += oc->input->size;
+    if (oc->output)
+        used += oc->output->size;
+    if (used > oc->buffer_peak)
+        oc->buffer_peak = used;
+    oc->buffer_allocs++;
+}
+
+void
+GetClientBufferStats(ClientPtr client, ClientBufferStatsPtr stats)
+{
+    OsCommPtr oc = (OsCommPtr) client->osPrivate;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!oc)
+        return;
+
+    if (oc->input)
+        stats->input = oc->input->size;
+    if (oc->output)
+        stats->output = oc->output->size;
+    stats->peak = oc->buffer_peak;
+    stats->allocs = oc->buffer_allocs;
+}
+
+void
+GetBufferPoolStats(unsigned int *buffers, unsigned int *bytes)
+{
+    int class;
+
+    *buffers = *bytes = 0;
+    for (class = 0; class < BUF_CLASSES; class++) {
+        *buffers += bufferPool[class].nfree;
+        *bytes += bufferPool[class].nfree * (BUFSIZE << class);
     }
-    oc->output = (ConnectionOutputPtr) NULL;
-    return extraCount;          /* return only the amount explicitly requested */
 }
 
 static ConnectionInputPtr
@@ -1040,15 +1284,17 @@ AllocateInputBuffer(void)
 {
     ConnectionInputPtr oci;
 
-    oci = malloc(sizeof(ConnectionInput));
-    if (!oci)
+    if ((oci = FreeInputs))
+        FreeInputs = oci->next;
+    else if (!(oci = malloc(sizeof(ConnectionInput))))
         return NULL;
-    oci->buffer = malloc(BUFSIZE);
+
+    oci->size = BUFSIZE;
+    oci->buffer = AllocateBuffer(&oci->size);
     if (!oci->buffer) {
         free(oci);
         return NULL;
     }
-    oci->size = BUFSIZE;
     oci->bufptr = oci->buffer;
     oci->bufcnt = 0;
     oci->lenLastReq = 0;
@@ -1061,52 +1307,60 @@ AllocateOutputBuffer(void)
 {
     ConnectionOutputPtr oco;
 
-    oco = malloc(sizeof(ConnectionOutput));
-    if (!oco)
+    if ((oco = FreeOutputs))
+        FreeOutputs = oco->next;
+    else if (!(oco = malloc(sizeof(ConnectionOutput))))
         return NULL;
-    oco->buf = calloc(1, BUFSIZE);
+
+    oco->size = BUFSIZE;
+    oco->buf = AllocateBuffer(&oco->size);
     if (!oco->buf) {
         free(oco);
         return NULL;
     }
-    oco->size = BUFSIZE;
     oco->count = 0;
+    oco->owned = NULL;
     return oco;
 }
 
+/* Return the buffer to the pool, and keep the structure for reuse */
+static void
+FreeInputBuffer(ConnectionInputPtr oci)
+{
+    FreeBuffer(oci->buffer, oci->size);
+    oci->buffer = NULL;
+    oci->next = FreeInputs;
+    FreeInputs = oci;
+}
+
+static void
+FreeOutputData(ConnectionOutputPtr oco)
+{
+    if (oco->owned)
+        free(oco->owned);
+    else
+        FreeBuffer(oco->buf, oco->size);
+    oco->owned = NULL;
+}
+
+static void
+FreeOutputBuffer(ConnectionOutputPtr oco)
+{
+    FreeOutputData(oco);
+    oco->buf = NULL;
+    oco->next = FreeOutputs;
+    FreeOutputs = oco;
+}
+
 void
 FreeOsBuffers(OsCommPtr oc)
 {
-    ConnectionInputPtr oci;
-    ConnectionOutputPtr oco;
-
     if (AvailableInput == oc)
         AvailableInput = (OsCommPtr) NULL;
-    if ((oci = oc->input)) {
-        if (FreeInputs) {
-            free(oci->buffer);
-            free(oci);
-        }
-        else {
-            FreeInputs = oci;
-            oci->next = (ConnectionInputPtr) NULL;
-            oci->bufptr = oci->buffer;
-            oci->bufcnt = 0;
-            oci->lenLastReq = 0;
-            oci->ignoreBytes = 0;
-        }
-    }
-    if ((oco = oc->output)) {
-        if (FreeOutputs) {
-            free(oco->buf);
-            free(oco);
-        }
-        else {
-            FreeOutputs = oco;
-            oco->next = (ConnectionOutputPtr) NULL;
-            oco->count = 0;
-        }
-    }
+    if (oc->input)
+        FreeInputBuffer(oc->input);
+    if (oc->output)
+        FreeOutputBuffer(oc->output);
 }
 
 void
@@ -1114,15 +1368,23 @@ ResetOsBuffers(void)
 {
     ConnectionInputPtr oci;
     ConnectionOutputPtr oco;
+    int class;
 
     while ((oci = FreeInputs)) {
         FreeInputs = oci->next;
-        free(oci->buffer);
         free(oci);
     }
     while ((oco = FreeOutputs)) {
         FreeOutputs = oco->next;
-        free(oco->buf);
         free(oco);
     }
+    for (class = 0; class < BUF_CLASSES; class++) {
+        PoolBufferPtr pb;
+
+        while ((pb = bufferPool[class].free)) {
+            bufferPool[class].free = pb->next;
+            free(pb);
+        }
+        bufferPool[class].nfree = bufferPool[class].lowfree = 0;
+    }
 }
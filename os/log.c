@@ -100,6 +100,12 @@ OR PERFORMANCE OF THIS SOFTWARE.
 #include "xf86bigfontsrv.h"
 #endif
 
+#ifdef ASYNC_LOG
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#endif
+
 #ifdef __clang__
 #pragma clang diagnostic ignored "-Wformat-nonliteral"
 #endif
@@ -120,6 +126,182 @@ static char *saveBuffer = NULL;
 static int bufferSize = 0, bufferUnused = 0, bufferPos = 0;
 static Bool needBuffer = TRUE;
 
+#ifdef ASYNC_LOG
+/*
+ * Log file writes from the main thread are copied into a ring buffer and
+ * written out by a background thread, so that a slow disk cannot stall
+ * dispatch.  The main thread is the only producer and the writer thread
+ * the only consumer, so head and tail are each written by one side only.
+ * When the ring is full, messages are dropped and counted rather than
+ * blocking; the writer reports the count once it catches up.
+ *
+ * Signal handlers, other threads and fatal errors bypass the ring and
+ * write to the log file directly, as before.
+ */
+#define LOG_RING_SIZE   (256 * 1024)    /* must be a power of two */
+
+static struct {
+    Bool enabled;               /* XLOG_ASYNC */
+    Bool running;               /* writer thread exists */
+    Bool stopping;              /* producers must bypass the ring */
+    Bool abandoned;             /* writer left behind by a fatal error */
+    pthread_t thread;
+    pthread_t main_thread;
+    sem_t wakeup;
+    size_t head;                /* advanced by the main thread */
+    size_t tail;                /* advanced by the writer thread */
+    unsigned long dropped;      /* not yet reported by the writer */
+    unsigned long total_dropped;
+    char buf[LOG_RING_SIZE];
+} logRing = { .enabled = TRUE };
+
+static void *
+LogWriterThread(void *arg)
+{
+    for (;;) {
+        size_t head = __atomic_load_n(&logRing.head, __ATOMIC_ACQUIRE);
+        size_t tail = logRing.tail;
+        unsigned long dropped;
+
+        while (tail != head) {
+            size_t offset = tail & (LOG_RING_SIZE - 1);
+            size_t len = min(head - tail, LOG_RING_SIZE - offset);
+            ssize_t written = write(logFileFd, logRing.buf + offset, len);
+
+            if (written < 0 && errno == EINTR)
+                continue;
+            /* Nowhere to report a failed write, drop the data */
+            if (written <= 0)
+                written = len;
+
+            tail += written;
+            __atomic_store_n(&logRing.tail, tail, __ATOMIC_RELEASE);
+        }
+
+        dropped = __atomic_exchange_n(&logRing.dropped, 0, __ATOMIC_RELAXED);
+        if (dropped) {
+            char msg[128];
+            int len = snprintf(msg, sizeof(msg),
+                               "[%10.3f] (WW) %lu log messages dropped, "
+                               "log file writes too slow\n",
+                               GetTimeInMillis() / 1000.0,
+                               dropped);
+
+            if (write(logFileFd, msg, len) < 0) {
+                /* nothing to do about it */
+            }
+        }
+
+        if (__atomic_load_n(&logRing.stopping, __ATOMIC_ACQUIRE) &&
+            tail == __atomic_load_n(&logRing.head, __ATOMIC_ACQUIRE))
+            break;
+
+        while (sem_wait(&logRing.wakeup) != 0 && errno == EINTR)
+            ;
+    }
+
+    return NULL;
+}
+
+static void
+LogWriterStart(void)
+{
+    sigset_t all, old;
+
+    if (logRing.running || logRing.abandoned || !logRing.enabled || logSync ||
+        logFileFd < 0)
+        return;
+
+    if (sem_init(&logRing.wakeup, 0, 0) != 0)
+        return;
+
+    /* The writer bypasses stdio, so nothing may be left buffered there */
+    if (logFile)
+        fflush(logFile);
+
+    logRing.head = logRing.tail = 0;
+    logRing.stopping = FALSE;
+    logRing.main_thread = pthread_self();
+
+    /* The server's signal handlers must only ever run on the main thread */
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    logRing.running =
+        pthread_create(&logRing.thread, NULL, LogWriterThread, NULL) == 0;
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (!logRing.running)
+        sem_destroy(&logRing.wakeup);
+}
+
+/*
+ * Make producers bypass the ring.  If wait is set, also wait for the
+ * writer thread to drain the ring and exit.  Fatal errors do not wait, as
+ * the disk may be what is stuck; their messages may then be written ahead
+ * of ones still queued.  The writer is detached and abandoned then, so
+ * that LogClose() on the way out does not join it after all, and it is
+ * never restarted.
+ */
+static void
+LogWriterStop(Bool wait)
+{
+    if (!logRing.running)
+        return;
+
+    __atomic_store_n(&logRing.stopping, TRUE, __ATOMIC_RELEASE);
+    sem_post(&logRing.wakeup);
+
+    if (wait) {
+        pthread_join(logRing.thread, NULL);
+        sem_destroy(&logRing.wakeup);
+    }
+    else {
+        pthread_detach(logRing.thread);
+        logRing.abandoned = TRUE;
+    }
+    logRing.running = FALSE;
+}
+
+static inline Bool
+LogWriterActive(void)
+{
+    return logRing.running &&
+        !__atomic_load_n(&logRing.stopping, __ATOMIC_ACQUIRE) &&
+        pthread_equal(pthread_self(), logRing.main_thread);
+}
+
+static void
+LogRingCopy(size_t pos, const char *data, size_t len)
+{
+    size_t offset = pos & (LOG_RING_SIZE - 1);
+    size_t first = min(len, LOG_RING_SIZE - offset);
+
+    memcpy(logRing.buf + offset, data, first);
+    memcpy(logRing.buf, data + first, len - first);
+}
+
+/* Queue a message for the writer thread, or drop it if there is no room */
+static void
+LogRingWrite(const char *prefix, size_t prefix_len,
+             const char *buf, size_t len)
+{
+    size_t head = logRing.head;
+    size_t tail = __atomic_load_n(&logRing.tail, __ATOMIC_ACQUIRE);
+
+    if (LOG_RING_SIZE - (head - tail) < prefix_len + len) {
+        __atomic_add_fetch(&logRing.dropped, 1, __ATOMIC_RELAXED);
+        logRing.total_dropped++;
+        return;
+    }
+
+    LogRingCopy(head, prefix, prefix_len);
+    LogRingCopy(head + prefix_len, buf, len);
+    __atomic_store_n(&logRing.head, head + prefix_len + len,
+                     __ATOMIC_RELEASE);
+    sem_post(&logRing.wakeup);
+}
+#endif
+
 #ifdef __APPLE__
 #include <AvailabilityMacros.h>
 
@@ -290,6 +472,10 @@ LogInit(const char *fname, const char *backup)
     }
     needBuffer = FALSE;
 
+#ifdef ASYNC_LOG
+    LogWriterStart();
+#endif
+
     return logFileName;
 }
 
@@ -328,6 +514,14 @@ LogClose(enum ExitCode error)
 {
     if (logFile) {
         int msgtype = (error == EXIT_NO_ERROR) ? X_INFO : X_ERROR;
+
+#ifdef ASYNC_LOG
+        LogWriterStop(TRUE);
+        if (logRing.total_dropped)
+            LogMessageVerbSigSafe(X_WARNING, -1,
+                                  "%lu log messages were dropped.\n",
+                                  logRing.total_dropped);
+#endif
         LogMessageVerbSigSafe(msgtype, -1,
                 "Server terminated %s (%d). Closing log file.\n",
                 (error == EXIT_NO_ERROR) ? "successfully" : "with error",
@@ -347,6 +541,12 @@ LogSetParameter(LogParameter param, int value)
         return TRUE;
     case XLOG_SYNC:
         logSync = value ? TRUE : FALSE;
+#ifdef ASYNC_LOG
+        /* fsync() after every message only makes sense when writing
+         * from the main thread */
+        if (logSync)
+            LogWriterStop(TRUE);
+#endif
         return TRUE;
     case XLOG_VERBOSITY:
         logVerbosity = value;
@@ -354,6 +554,17 @@ LogSetParameter(LogParameter param, int value)
     case XLOG_FILE_VERBOSITY:
         logFileVerbosity = value;
         return TRUE;
+    case XLOG_ASYNC:
+#ifdef ASYNC_LOG
+        logRing.enabled = value ? TRUE : FALSE;
+        if (logRing.enabled)
+            LogWriterStart();
+        else
+            LogWriterStop(TRUE);
+        return TRUE;
+#else
+        return !value;
+#endif
     default:
         return FALSE;
     }
@@ -609,6 +820,18 @@ LogSWrite(int verb, const char *buf, size_t len, Bool end_line)
                 fsync(logFileFd);
 #endif
         }
+#ifdef ASYNC_LOG
+        else if (!inSignalContext && LogWriterActive()) {
+            char prefix[32];
+            int prefix_len = 0;
+
+            if (newline)
+                prefix_len = snprintf(prefix, sizeof(prefix), "[%10.3f] ",
+                                      GetTimeInMillis() / 1000.0);
+            newline = end_line;
+            LogRingWrite(prefix, prefix_len, buf, len);
+        }
+#endif
         else if (!inSignalContext && logFile) {
             if (newline)
                 fprintf(logFile, "[%10.3f] ", GetTimeInMillis() / 1000.0);
@@ -984,6 +1207,10 @@ FatalError(const char *f, ...)
     va_list args2;
     static Bool beenhere = FALSE;
 
+#ifdef ASYNC_LOG
+    LogWriterStop(FALSE);
+#endif
+
     if (beenhere)
         ErrorFSigSafe("\nFatalError re-entered, aborting\n");
     else
@@ -148,6 +148,8 @@ typedef struct _osComm {
     XID auth_id;                /* authorization id */
     CARD32 conn_time;           /* timestamp if not established, else 0  */
     struct _XtransConnInfo *trans_conn; /* transport connection object */
+    unsigned int buffer_peak;   /* most I/O buffer bytes held at once */
+    unsigned int buffer_allocs; /* I/O buffers taken from the pool */
 } OsCommRec, *OsCommPtr;
 
 extern int FlushClient(ClientPtr /*who */ ,
@@ -139,6 +139,9 @@ static int numEnabledRCAPs;
 static int RecordDeleteContext(void     *value,
                                XID      id);
 
+static void RecordAClientStateChange(CallbackListPtr *pcbl,
+                                     void *nulldata, void *calldata);
+
 /***************************************************************************/
 
 /* client private stuff */
@@ -1858,6 +1861,11 @@ ProcRecordCreateContext(ClientPtr client)
         goto bailout;
     ppAllContexts = ppNewAllContexts;
 
+    /* Clients only need watching while there are contexts to record them */
+    if (!numContexts &&
+        !AddCallback(&ClientStateCallback, RecordAClientStateChange, NULL))
+        goto bailout;
+
     pContext->id = stuff->context;
     pContext->pRecordingClient = NULL;
     pContext->pListOfRCAP = NULL;
@@ -1881,6 +1889,8 @@ ProcRecordCreateContext(ClientPtr client)
         return BadAlloc;
     }
  bailout:
+    if (!numContexts)
+        DeleteCallback(&ClientStateCallback, RecordAClientStateChange, NULL);
     free(pContext);
     return err;
 }                               /* ProcRecordCreateContext */
@@ -2440,6 +2450,8 @@ RecordDeleteContext(void *value, XID id)
             ppAllContexts = NULL;
         }
     }
+    if (!numContexts)
+        DeleteCallback(&ClientStateCallback, RecordAClientStateChange, NULL);
     free(pContext);
 
     return Success;
@@ -2800,16 +2812,11 @@ RecordExtensionInit(void)
     ppAllContexts = NULL;
     numContexts = numEnabledContexts = numEnabledRCAPs = 0;
 
-    if (!AddCallback(&ClientStateCallback, RecordAClientStateChange, NULL))
-        return;
-
     extentry = AddExtension(RECORD_NAME, RecordNumEvents, RecordNumErrors,
                             ProcRecordDispatch, SProcRecordDispatch,
                             RecordCloseDown, StandardMinorOpcode);
-    if (!extentry) {
-        DeleteCallback(&ClientStateCallback, RecordAClientStateChange, NULL);
+    if (!extentry)
         return;
-    }
     SetResourceTypeErrorValue(RTContext,
                               extentry->errorBase + XRecordBadContext);
 
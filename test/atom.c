@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <X11/Xatom.h>
+
+#include "misc.h"
+#include "dix.h"
+
+#include "bench.h"
+
+/**
+ * Tests and benchmarks for the atom table in dix/atom.c.
+ */
+
+#define NUM_BENCH_ATOMS 100000
+
+static void
+atom_predefined(void)
+{
+    assert(MakeAtom("PRIMARY", 7, FALSE) == XA_PRIMARY);
+    assert(MakeAtom("WM_TRANSIENT_FOR", 16, FALSE) == XA_WM_TRANSIENT_FOR);
+    assert(strcmp(NameForAtom(XA_STRING), "STRING") == 0);
+    assert(ValidAtom(XA_LAST_PREDEFINED));
+    assert(!ValidAtom(None));
+    assert(NameForAtom(None) == NULL);
+}
+
+static void
+atom_make(void)
+{
+    Atom a, b;
+
+    assert(MakeAtom("_TEST_ATOM", 10, FALSE) == None);
+    a = MakeAtom("_TEST_ATOM", 10, TRUE);
+    assert(a > XA_LAST_PREDEFINED);
+    assert(ValidAtom(a));
+    assert(MakeAtom("_TEST_ATOM", 10, FALSE) == a);
+    assert(strcmp(NameForAtom(a), "_TEST_ATOM") == 0);
+
+    /* Only len bytes of the name count */
+    assert(MakeAtom("_TEST_ATOM_LONGER", 10, FALSE) == a);
+    b = MakeAtom("_TEST_ATOM_LONGER", 17, TRUE);
+    assert(b != a);
+    assert(MakeAtom("_TEST_ATO", 9, FALSE) == None);
+
+    /* Names stop at an embedded NUL */
+    assert(MakeAtom("_TEST_ATOM\0junk", 15, FALSE) == a);
+}
+
+static void
+atom_batch(void)
+{
+    const char *names[] = { "PRIMARY", "_BATCH_A", "_BATCH_B", "_BATCH_A" };
+    unsigned lens[] = { 7, 8, 8, 8 };
+    Atom atoms[4];
+
+    assert(MakeAtoms(names, lens, 4, FALSE, atoms));
+    assert(atoms[0] == XA_PRIMARY);
+    assert(atoms[1] == None && atoms[2] == None && atoms[3] == None);
+
+    assert(MakeAtoms(names, lens, 4, TRUE, atoms));
+    assert(atoms[0] == XA_PRIMARY);
+    assert(atoms[1] != None && atoms[2] != None);
+    assert(atoms[1] != atoms[2]);
+    assert(atoms[3] == atoms[1]);
+    assert(MakeAtom("_BATCH_B", 8, FALSE) == atoms[2]);
+}
+
+/* Enough atoms for the table to grow several times */
+static void
+atom_grow(void)
+{
+    char name[32];
+    Atom first = None;
+    int i, len;
+
+    for (i = 0; i < 5000; i++) {
+        Atom a;
+
+        len = snprintf(name, sizeof(name), "_TEST_GROW_%d", i);
+        a = MakeAtom(name, len, TRUE);
+        if (i == 0)
+            first = a;
+        assert(a == first + i);
+    }
+
+    for (i = 0; i < 5000; i++) {
+        len = snprintf(name, sizeof(name), "_TEST_GROW_%d", i);
+        assert(MakeAtom(name, len, FALSE) == first + i);
+        assert(strcmp(NameForAtom(first + i), name) == 0);
+    }
+    assert(MakeAtom("_TEST_GROW_", 11, FALSE) == None);
+}
+
+static void
+atom_benchmark(void)
+{
+    static char names[NUM_BENCH_ATOMS][32];
+    static const char *strings[NUM_BENCH_ATOMS];
+    static unsigned lens[NUM_BENCH_ATOMS];
+    static Atom atoms[NUM_BENCH_ATOMS];
+    struct timespec start;
+    Atom first;
+    int i;
+
+    /* Generated names sharing long prefixes, like per-object properties */
+    for (i = 0; i < NUM_BENCH_ATOMS; i++) {
+        lens[i] = snprintf(names[i], sizeof(names[i]),
+                           "_TEST_GENERATED_PROPERTY_%d", i);
+        strings[i] = names[i];
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    first = MakeAtom(strings[0], lens[0], TRUE);
+    for (i = 1; i < NUM_BENCH_ATOMS; i++)
+        assert(MakeAtom(strings[i], lens[i], TRUE) == first + i);
+    printf("intern: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_ATOMS));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_ATOMS; i++) {
+        int j = (i * 7919) % NUM_BENCH_ATOMS;
+
+        assert(MakeAtom(strings[j], lens[j], FALSE) == first + j);
+    }
+    printf("lookup: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_ATOMS));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_ATOMS; i++)
+        assert(MakeAtom(strings[i] + 1, lens[i] - 1, FALSE) == None);
+    printf("failed lookup: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_ATOMS));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_ATOMS; i++)
+        assert(strcmp(NameForAtom(first + i), strings[i]) == 0);
+    printf("name for atom: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_ATOMS));
+
+    /* A fresh table, interned in one batch */
+    InitAtoms();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    assert(MakeAtoms(strings, lens, NUM_BENCH_ATOMS, TRUE, atoms));
+    printf("batched intern: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_ATOMS));
+    for (i = 0; i < NUM_BENCH_ATOMS; i++)
+        assert(atoms[i] == atoms[0] + i);
+}
+
+int
+main(int argc, char **argv)
+{
+    InitAtoms();
+
+    atom_predefined();
+    atom_make();
+    atom_batch();
+    atom_grow();
+    if (benchmark_requested(argc, argv))
+        atom_benchmark();
+
+    FreeAllAtoms();
+
+    return 0;
+}
@@ -0,0 +1,334 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "misc.h"
+#include "resource.h"
+#include "dixstruct.h"
+#include "privates.h"
+#include "windowstr.h"
+#include "inputstr.h"
+#include "eventstr.h"
+#include "exevents.h"
+#include "dixgrabs.h"
+#include "dixevents.h"
+
+#include "bench.h"
+
+/**
+ * Tests and benchmarks for the passive grab index in dix/grabs.c.
+ */
+
+#define FIRST_KEY 8
+#define LAST_KEY 255
+#define MAX_MATCHES 1024
+#define NUM_BENCH_LOOKUPS 200000
+
+static ClientRec server_client, test_client;
+static DeviceIntRec keyboard;
+static WindowRec root;
+
+static const unsigned int test_mods[] = {
+    0, ShiftMask, ControlMask, Mod4Mask, ShiftMask | Mod4Mask, AnyModifier
+};
+
+static void
+grabs_init(void)
+{
+    dixResetPrivates();
+    serverClient = &server_client;
+    InitClient(serverClient, 0, (void *) NULL);
+    if (!InitClientResources(serverClient))
+        FatalError("couldn't init server resources");
+
+    clients[1] = &test_client;
+    InitClient(&test_client, 1, (void *) NULL);
+    if (!InitClientResources(&test_client))
+        FatalError("couldn't init client resources");
+    currentMaxClients = 2;
+
+    keyboard.id = 3;
+    keyboard.type = MASTER_KEYBOARD;
+    root.optional = calloc(1, sizeof(WindowOptRec));
+    assert(root.optional);
+}
+
+static GrabPtr
+make_grab(unsigned int key, unsigned int modifiers)
+{
+    GrabParameters param = { 0 };
+    GrabMask mask = { .core = KeyPressMask };
+
+    param.ownerEvents = FALSE;
+    param.this_device_mode = GrabModeAsync;
+    param.other_devices_mode = GrabModeAsync;
+    param.modifiers = modifiers;
+
+    return CreateGrab(test_client.index, &keyboard, &keyboard, &root, CORE,
+                      &mask, &param, KeyPress, key, NULL, NULL);
+}
+
+static void
+add_grab(unsigned int key, unsigned int modifiers)
+{
+    GrabPtr grab = make_grab(key, modifiers);
+
+    assert(grab);
+    assert(AddPassiveGrabToList(&test_client, grab) == Success);
+}
+
+static void
+remove_grab(unsigned int key, unsigned int modifiers)
+{
+    GrabPtr grab = make_grab(key, modifiers);
+
+    assert(grab);
+    assert(DeletePassiveGrabFromList(grab));
+    FreeGrab(grab);
+}
+
+static int
+count_grabs(void)
+{
+    GrabPtr grab;
+    int count = 0;
+
+    for (grab = wPassiveGrabs(&root); grab; grab = grab->next)
+        count++;
+    return count;
+}
+
+/* The grabs matching detail and modifiers, by walking the whole list */
+static int
+list_matches(GrabPtr tmp, GrabPtr *matches)
+{
+    GrabPtr grab;
+    int n = 0;
+
+    for (grab = wPassiveGrabs(&root); grab; grab = grab->next)
+        if (GrabMatchesSecond(tmp, grab, TRUE)) {
+            assert(n < MAX_MATCHES);
+            matches[n++] = grab;
+        }
+    return n;
+}
+
+/* The same through the index, also counting the candidates tried */
+static int
+indexed_matches(GrabPtr tmp, GrabPtr *matches, int *candidates)
+{
+    PassiveGrabIterRec iter;
+    GrabPtr grab;
+    int n = 0;
+
+    *candidates = 0;
+    for (grab = FirstPassiveGrab(&root, tmp->detail.exact, &iter); grab;
+         grab = NextPassiveGrab(&iter)) {
+        (*candidates)++;
+        if (GrabMatchesSecond(tmp, grab, TRUE)) {
+            assert(n < MAX_MATCHES);
+            matches[n++] = grab;
+        }
+    }
+    return n;
+}
+
+/* Every detail and modifier state finds the same grabs in the same order
+ * as a walk of the whole list */
+static void
+check_all_details(int max_candidates)
+{
+    GrabPtr tmp = make_grab(0, 0);
+    GrabPtr expect[MAX_MATCHES], got[MAX_MATCHES];
+    unsigned int key;
+    int m, i, n, candidates;
+
+    assert(tmp);
+    for (key = 0; key <= LAST_KEY; key++) {
+        for (m = 0; m < ARRAY_SIZE(test_mods); m++) {
+            tmp->detail.exact = key;
+            tmp->modifiersDetail.exact = test_mods[m];
+
+            n = list_matches(tmp, expect);
+            assert(indexed_matches(tmp, got, &candidates) == n);
+            for (i = 0; i < n; i++)
+                assert(got[i] == expect[i]);
+            if (key != AnyKey)
+                assert(candidates <= max_candidates);
+        }
+    }
+    FreeGrab(tmp);
+}
+
+static GrabPtr
+check_passive_grabs(unsigned int key)
+{
+    InternalEvent event;
+
+    memset(&event, 0, sizeof(event));
+    event.any.type = ET_KeyPress;
+    event.device_event.detail.key = key;
+    return CheckPassiveGrabsOnWindow(&root, &keyboard, &event, TRUE, FALSE);
+}
+
+static void
+grabs_small_list(void)
+{
+    add_grab(38, 0);
+    add_grab(AnyKey, Mod4Mask);
+    add_grab(39, AnyModifier);
+
+    /* Too few grabs to be worth an index */
+    check_all_details(3);
+    assert(root.optional->grabIndex == NULL);
+    assert(check_passive_grabs(38)->detail.exact == 38);
+    assert(check_passive_grabs(39)->detail.exact == 39);
+    assert(check_passive_grabs(40) == NULL);
+
+    FreeClientResources(&test_client);
+    assert(InitClientResources(&test_client));
+    assert(wPassiveGrabs(&root) == NULL);
+}
+
+static void
+grabs_large_list(void)
+{
+    unsigned int key;
+    GrabPtr grab;
+
+    /* A key binding for each key with and without Shift, as a window
+     * manager would set up on the root window */
+    for (key = FIRST_KEY; key <= LAST_KEY; key++) {
+        add_grab(key, 0);
+        add_grab(key, ShiftMask);
+        if (key % 16 == 0)
+            add_grab(key, AnyModifier);
+    }
+    add_grab(AnyKey, Mod4Mask);
+    add_grab(AnyKey, ControlMask | Mod4Mask);
+
+    /* Per detail: two exact grabs, the odd AnyModifier one, the two
+     * AnyKey grabs and whatever shares the bucket */
+    check_all_details(12);
+    assert(root.optional->grabIndex != NULL);
+
+    for (key = FIRST_KEY; key <= LAST_KEY; key++) {
+        grab = check_passive_grabs(key);
+        assert(grab && grab->detail.exact == key);
+        assert(grab->modifiersDetail.exact == ((key % 16) ? 0 : AnyModifier));
+    }
+    assert(check_passive_grabs(1) == NULL);
+
+    /* Newer grabs hide older ones for the same event */
+    add_grab(100, AnyModifier);
+    grab = check_passive_grabs(100);
+    assert(grab == wPassiveGrabs(&root));
+    check_all_details(12);
+
+    /* Removing grabs, including ungrabs that split or mask others */
+    for (key = FIRST_KEY; key <= LAST_KEY; key += 3)
+        remove_grab(key, 0);
+    remove_grab(AnyKey, ShiftMask);
+    remove_grab(64, AnyModifier);
+    remove_grab(AnyKey, Mod4Mask);
+    add_grab(AnyKey, Mod4Mask);
+    check_all_details(12);
+
+    for (key = FIRST_KEY; key <= LAST_KEY; key++) {
+        grab = check_passive_grabs(key);
+        if ((key - FIRST_KEY) % 3 == 0 || key == 64)
+            assert(grab == NULL);
+        else if (key % 16 == 0 || key == 100)
+            assert(grab && grab->detail.exact == key &&
+                   grab->modifiersDetail.exact == AnyModifier);
+        else
+            assert(grab && grab->detail.exact == key &&
+                   grab->modifiersDetail.exact == 0);
+    }
+
+    /* The index goes away with the last grab */
+    FreeClientResources(&test_client);
+    assert(InitClientResources(&test_client));
+    assert(wPassiveGrabs(&root) == NULL);
+    assert(root.optional->grabIndex == NULL);
+}
+
+static void
+grabs_benchmark(void)
+{
+    struct timespec start;
+    GrabPtr tmp, expect[MAX_MATCHES];
+    unsigned int key;
+    int m, i;
+
+    for (key = FIRST_KEY; key <= LAST_KEY; key++)
+        for (m = 0; m < 4; m++)
+            add_grab(key, test_mods[m]);
+    printf("%d grabs\n", count_grabs());
+
+    /* Keys without a grab have to look at every grab without the index */
+    tmp = make_grab(0, 0);
+    assert(tmp);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_LOOKUPS / 100; i++) {
+        tmp->detail.exact = 1;
+        list_matches(tmp, expect);
+    }
+    printf("list walk: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_LOOKUPS / 100));
+    FreeGrab(tmp);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_LOOKUPS; i++)
+        check_passive_grabs(1);
+    printf("ungrabbed key: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_LOOKUPS));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_LOOKUPS; i++)
+        check_passive_grabs(FIRST_KEY + i % (LAST_KEY - FIRST_KEY + 1));
+    printf("grabbed key: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_LOOKUPS));
+
+    FreeClientResources(&test_client);
+    assert(InitClientResources(&test_client));
+}
+
+int
+main(int argc, char **argv)
+{
+    grabs_init();
+
+    grabs_small_list();
+    grabs_large_list();
+    if (benchmark_requested(argc, argv))
+        grabs_benchmark();
+
+    return 0;
+}
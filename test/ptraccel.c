@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include "misc.h"
+#include "inputstr.h"
+#include "inpututils.h"
+#include "ptrveloc.h"
+
+#include "bench.h"
+
+/**
+ * Tests and benchmarks for the velocity trackers of the predictable pointer
+ * acceleration in dix/ptrveloc.c.  Motion is fed at 1000 Hz through the
+ * device's acceleration scheme, the way GetPointerEvents() applies it.
+ */
+
+#define NUM_BENCH_EVENTS 1000000
+
+static DeviceIntRec dev;
+static CARD32 now = 1000;       /* event time, in ms */
+
+static void
+ptr_ctrl(DeviceIntPtr pDev, PtrCtrl * ctrl)
+{
+}
+
+static void
+ptraccel_init(void)
+{
+    Atom labels[2] = { 0 };
+
+    InitAtoms();
+
+    memset(&dev, 0, sizeof(dev));
+    dev.name = xnfstrdup("pointer");
+    dev.type = SLAVE;
+    assert(InitValuatorClassDeviceStruct(&dev, 2, labels, 0, Relative));
+    assert(InitPtrFeedbackClassDeviceStruct(&dev, ptr_ctrl));
+    assert(GetDevicePredictableAccelData(&dev));
+
+    dev.ptrfeed->ctrl.num = 2;
+    dev.ptrfeed->ctrl.den = 1;
+    dev.ptrfeed->ctrl.threshold = 4;
+}
+
+static void
+accelerate(ValuatorMask *mask, double dx, double dy, CARD32 time)
+{
+    valuator_mask_zero(mask);
+    valuator_mask_set_double(mask, 0, dx);
+    valuator_mask_set_double(mask, 1, dy);
+    dev.valuator->accelScheme.AccelSchemeProc(&dev, mask, time);
+}
+
+static void
+ptraccel_trackers(void)
+{
+    DeviceVelocityPtr vel = GetDevicePredictableAccelData(&dev);
+    ValuatorMask *mask = valuator_mask_new(2);
+    int i;
+
+    /* Straight motion keeps its velocity, and is far enough for the
+     * tracker sums to be rebased along the way */
+    for (i = 0; i < 100000; i++, now++) {
+        accelerate(mask, 3, -1, now);
+        if (i > vel->num_tracker)
+            assert(fabs(vel->velocity - sqrt(10) * vel->corr_mul) < 1e-6);
+    }
+
+    /* Turning around starts over */
+    accelerate(mask, -3, 1, now++);
+    assert(fabs(vel->velocity - sqrt(10) * vel->corr_mul) < 1e-6);
+    for (i = 0; i < 100; i++, now++)
+        accelerate(mask, -1, 0, now);
+    assert(fabs(vel->velocity - vel->corr_mul) < 1e-6);
+
+    /* A pause resets the velocity */
+    now += 1000;
+    accelerate(mask, 1, 0, now++);
+    assert(vel->velocity == 0);
+
+    /* Fewer trackers start over from an empty ring */
+    InitTrackers(vel, 4);
+    for (i = 0; i < 10; i++, now++)
+        accelerate(mask, 0, 2, now);
+    assert(fabs(vel->velocity - 2 * vel->corr_mul) < 1e-6);
+    InitTrackers(vel, 16);
+
+    free(mask);
+}
+
+/* Speed rising and falling between 0 and 20 units per ms */
+static void
+ptraccel_benchmark(void)
+{
+    ValuatorMask *mask = valuator_mask_new(2);
+    struct timespec start;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_EVENTS; i++, now++) {
+        double speed = 20 * (0.5 - 0.5 * cos(i * 0.003));
+        double angle = i * 0.0007;
+
+        accelerate(mask, round(speed * cos(angle)), round(speed * sin(angle)),
+                   now);
+    }
+    printf("accelerated motion: %.1f ns/event\n",
+           elapsed_ns(&start, NUM_BENCH_EVENTS));
+
+    free(mask);
+}
+
+int
+main(int argc, char **argv)
+{
+    ptraccel_init();
+
+    ptraccel_trackers();
+    if (benchmark_requested(argc, argv))
+        ptraccel_benchmark();
+
+    return 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "misc.h"
+#include "regionstr.h"
+
+#include "bench.h"
+
+/**
+ * Tests and benchmarks for the region builder and RegionValidate in
+ * dix/region.c.
+ */
+
+#define MAX_BOXES 100000
+
+static BoxRec boxes[MAX_BOXES];
+static unsigned int seed = 1;
+
+static int
+random_int(int n)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % n;
+}
+
+/* Random boxes over span x span pixels, a few of them empty */
+static void
+random_boxes(int n, int span, int size)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        boxes[i].x1 = random_int(span);
+        boxes[i].y1 = random_int(span);
+        boxes[i].x2 = boxes[i].x1 + random_int(size);
+        boxes[i].y2 = boxes[i].y1 + random_int(size);
+    }
+}
+
+static void
+union_boxes(RegionPtr pReg, int n)
+{
+    int i;
+
+    RegionEmpty(pReg);
+    for (i = 0; i < n; i++) {
+        RegionRec r;
+
+        if (boxes[i].x1 >= boxes[i].x2 || boxes[i].y1 >= boxes[i].y2)
+            continue;
+        RegionInit(&r, &boxes[i], 0);
+        assert(RegionUnion(pReg, pReg, &r));
+    }
+}
+
+static void
+region_builder(void)
+{
+    RegionBuilderRec builder;
+    RegionRec expected, built, validated;
+    int iter;
+
+    RegionBuilderInit(&builder);
+    RegionNull(&expected);
+    RegionNull(&built);
+    RegionNull(&validated);
+
+    for (iter = 0; iter < 2000; iter++) {
+        int n = 1 + random_int(iter < 1000 ? 40 : 400);
+        int span = 1 + random_int(iter % 3 ? 64 : 2000);
+        int size = 1 + random_int(iter % 2 ? 16 : 300);
+        Bool overlap;
+        int i;
+
+        random_boxes(n, span, size);
+        union_boxes(&expected, n);
+
+        /* Added one at a time and all at once */
+        for (i = 0; i < n / 2; i++)
+            assert(RegionBuilderAddBox(&builder, &boxes[i]));
+        assert(RegionBuilderAddBoxes(&builder, boxes + n / 2, n - n / 2));
+        assert(RegionBuilderFinish(&builder, &built));
+        assert(RegionEqual(&expected, &built));
+        assert(RegionNumRects(&expected) == RegionNumRects(&built));
+
+        /* The same boxes appended as single box regions */
+        RegionEmpty(&validated);
+        for (i = 0; i < n; i++) {
+            RegionRec r;
+
+            if (boxes[i].x1 >= boxes[i].x2 || boxes[i].y1 >= boxes[i].y2)
+                continue;
+            RegionInit(&r, &boxes[i], 0);
+            assert(RegionAppend(&validated, &r));
+        }
+        assert(RegionValidate(&validated, &overlap));
+        assert(RegionEqual(&expected, &validated));
+    }
+
+    /* Regions feed back into a builder unchanged */
+    assert(RegionBuilderAddRegion(&builder, &expected));
+    assert(RegionBuilderFinish(&builder, &built));
+    assert(RegionEqual(&expected, &built));
+
+    /* Nothing added, or only empty boxes, gives an empty region */
+    assert(RegionBuilderFinish(&builder, &built));
+    assert(RegionNil(&built) && !RegionNar(&built));
+    boxes[0].x1 = boxes[0].x2 = 10;
+    boxes[0].y1 = 0;
+    boxes[0].y2 = 10;
+    assert(RegionBuilderAddBox(&builder, &boxes[0]));
+    assert(RegionBuilderFinish(&builder, &built));
+    assert(RegionNil(&built) && !RegionNar(&built));
+
+    /* A broken region breaks the result */
+    RegionBreak(&expected);
+    assert(!RegionBuilderAddRegion(&builder, &expected));
+    assert(!RegionBuilderFinish(&builder, &built));
+    assert(RegionNar(&built));
+
+    RegionUninit(&expected);
+    RegionUninit(&built);
+    RegionUninit(&validated);
+    RegionBuilderUninit(&builder);
+}
+
+static void
+region_validate_overlap(void)
+{
+    BoxRec a = { 0, 0, 10, 10 }, b = { 10, 0, 20, 10 }, c = { 5, 5, 15, 15 };
+    RegionRec reg, r;
+    Bool overlap;
+
+    /* Touching boxes merge without overlapping */
+    RegionNull(&reg);
+    RegionInit(&r, &b, 0);
+    assert(RegionAppend(&reg, &r));
+    RegionInit(&r, &a, 0);
+    assert(RegionAppend(&reg, &r));
+    assert(RegionValidate(&reg, &overlap));
+    assert(!overlap);
+    assert(RegionNumRects(&reg) == 1);
+    assert(reg.extents.x1 == 0 && reg.extents.x2 == 20);
+
+    RegionInit(&r, &c, 0);
+    assert(RegionAppend(&reg, &r));
+    assert(RegionValidate(&reg, &overlap));
+    assert(overlap);
+    assert(RegionNumRects(&reg) == 2);
+    RegionUninit(&reg);
+}
+
+static void
+region_benchmark(void)
+{
+    RegionBuilderRec builder;
+    RegionRec expected, built;
+    struct timespec start;
+    int n;
+
+    RegionBuilderInit(&builder);
+    RegionNull(&expected);
+    RegionNull(&built);
+
+    for (n = 1000; n <= MAX_BOXES; n *= 10) {
+        random_boxes(n, 2000, 40);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        union_boxes(&expected, n);
+        printf("%d boxes: RegionUnion %.1f ns/box", n, elapsed_ns(&start, n));
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        RegionBuilderAddBoxes(&builder, boxes, n);
+        RegionBuilderFinish(&builder, &built);
+        printf(", builder %.1f ns/box\n", elapsed_ns(&start, n));
+
+        assert(RegionEqual(&expected, &built));
+    }
+
+    RegionUninit(&expected);
+    RegionUninit(&built);
+    RegionBuilderUninit(&builder);
+}
+
+int
+main(int argc, char **argv)
+{
+    region_validate_overlap();
+    region_builder();
+    if (benchmark_requested(argc, argv))
+        region_benchmark();
+
+    return 0;
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "misc.h"
+#include "resource.h"
+#include "dixstruct.h"
+#include "privates.h"
+
+#include "bench.h"
+
+/**
+ * Tests and benchmarks for the per-client resource table in
+ * dix/resource.c.
+ */
+
+#define NUM_BENCH_RESOURCES 200000
+
+static RESTYPE rt_test, rt_other;
+static XID deleted[16];
+static int num_deleted;
+
+static int
+delete_test(void *value, XID id)
+{
+    if (num_deleted < ARRAY_SIZE(deleted))
+        deleted[num_deleted] = (XID) (intptr_t) value;
+    num_deleted++;
+    return Success;
+}
+
+static ClientRec server_client, test_client;
+
+static void
+resource_init(void)
+{
+    dixResetPrivates();
+    serverClient = &server_client;
+    InitClient(serverClient, 0, (void *) NULL);
+    if (!InitClientResources(serverClient))
+        FatalError("couldn't init server resources");
+
+    clients[1] = &test_client;
+    InitClient(&test_client, 1, (void *) NULL);
+    if (!InitClientResources(&test_client))
+        FatalError("couldn't init client resources");
+    currentMaxClients = 2;
+
+    rt_test = CreateNewResourceType(delete_test, "TEST");
+    rt_other = CreateNewResourceType(delete_test, "OTHER");
+    assert(rt_test && rt_other);
+}
+
+static void
+resource_add_lookup_free(void)
+{
+    XID base = test_client.clientAsMask;
+    void *value;
+    int i;
+
+    /* Many more resources than the old chained table could spread out */
+    for (i = 0; i < 20000; i++)
+        assert(AddResource(base + i, rt_test, (void *) (intptr_t) i));
+
+    for (i = 0; i < 20000; i++) {
+        assert(dixLookupResourceByType(&value, base + i, rt_test,
+                                       NULL, DixReadAccess) == Success);
+        assert(value == (void *) (intptr_t) i);
+        assert(dixLookupResourceByType(&value, base + i, rt_other,
+                                       NULL, DixReadAccess) != Success);
+    }
+    assert(dixLookupResourceByType(&value, base + 20000, rt_test,
+                                   NULL, DixReadAccess) != Success);
+
+    /* Free every other one, the rest must still be found */
+    num_deleted = 0;
+    for (i = 0; i < 20000; i += 2)
+        FreeResource(base + i, RT_NONE);
+    assert(num_deleted == 10000);
+
+    for (i = 0; i < 20000; i++) {
+        int rc = dixLookupResourceByType(&value, base + i, rt_test,
+                                         NULL, DixReadAccess);
+
+        assert((i & 1) ? rc == Success : rc != Success);
+    }
+
+    assert(ChangeResourceValue(base + 1, rt_test, (void *) 42));
+    assert(!ChangeResourceValue(base + 2, rt_test, (void *) 42));
+    assert(dixLookupResourceByType(&value, base + 1, rt_test,
+                                   NULL, DixReadAccess) == Success);
+    assert(value == (void *) 42);
+
+    FreeClientResources(&test_client);
+    assert(InitClientResources(&test_client));
+}
+
+static void
+resource_same_id(void)
+{
+    XID id = test_client.clientAsMask | 0x100;
+    void *value;
+
+    /* Resources sharing an id are freed newest first */
+    assert(AddResource(id, rt_test, (void *) 1));
+    assert(AddResource(id, rt_other, (void *) 2));
+    assert(AddResource(id, rt_test, (void *) 3));
+
+    assert(dixLookupResourceByType(&value, id, rt_test,
+                                   NULL, DixReadAccess) == Success);
+    assert(value == (void *) 3);
+
+    num_deleted = 0;
+    FreeResourceByType(id, rt_other, FALSE);
+    assert(num_deleted == 1 && deleted[0] == 2);
+
+    num_deleted = 0;
+    FreeResource(id, RT_NONE);
+    assert(num_deleted == 2);
+    assert(deleted[0] == 3 && deleted[1] == 1);
+    assert(dixLookupResourceByClass(&value, id, RC_ANY,
+                                    NULL, DixReadAccess) == BadValue);
+}
+
+static void
+resource_lookup_cache(void)
+{
+    XID id = test_client.clientAsMask | 0x200;
+    void *value;
+
+    assert(AddResource(id, rt_test, (void *) 1));
+    assert(dixLookupResourceByType(&value, id, rt_test,
+                                   NULL, DixReadAccess) == Success);
+    assert(value == (void *) 1);
+
+    /* A cached lookup must see changed values */
+    assert(ChangeResourceValue(id, rt_test, (void *) 2));
+    assert(dixLookupResourceByType(&value, id, rt_test,
+                                   NULL, DixReadAccess) == Success);
+    assert(value == (void *) 2);
+
+    /* ... and newer resources hiding the cached one */
+    assert(dixLookupResourceByClass(&value, id, RC_ANY,
+                                    NULL, DixReadAccess) == Success);
+    assert(value == (void *) 2);
+    assert(AddResource(id, rt_other, (void *) 3));
+    assert(dixLookupResourceByClass(&value, id, RC_ANY,
+                                    NULL, DixReadAccess) == Success);
+    assert(value == (void *) 3);
+
+    /* ... and freed resources */
+    FreeResourceByType(id, rt_test, TRUE);
+    assert(dixLookupResourceByType(&value, id, rt_test,
+                                   NULL, DixReadAccess) != Success);
+    FreeResource(id, RT_NONE);
+    assert(dixLookupResourceByClass(&value, id, RC_ANY,
+                                    NULL, DixReadAccess) == BadValue);
+}
+
+static void
+count_resource(void *value, XID id, void *cdata)
+{
+    (*(int *) cdata)++;
+}
+
+static void
+free_odd_resource(void *value, XID id, void *cdata)
+{
+    (*(int *) cdata)++;
+    if ((intptr_t) value & 1)
+        FreeResource(id + 1, RT_NONE);
+}
+
+static void
+resource_find_by_type(void)
+{
+    XID base = test_client.clientAsMask;
+    int i, count;
+
+    for (i = 0; i < 1000; i++)
+        assert(AddResource(base + i, (i % 10) ? rt_other : rt_test,
+                           (void *) (intptr_t) i));
+
+    count = 0;
+    FindClientResourcesByType(&test_client, rt_test, count_resource, &count);
+    assert(count == 100);
+
+    count = 0;
+    FindClientResourcesByType(&test_client, 0, count_resource, &count);
+    assert(count == 1000);
+
+    /* Freeing resources from the callback: every resource still around
+     * when the walk gets to it is visited exactly once */
+    count = 0;
+    FindClientResourcesByType(&test_client, rt_other, free_odd_resource,
+                              &count);
+    assert(count == 900 - 400);
+
+    FreeClientResources(&test_client);
+    assert(InitClientResources(&test_client));
+}
+
+static void
+resource_benchmark(void)
+{
+    XID base = test_client.clientAsMask;
+    struct timespec start;
+    void *value;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_RESOURCES; i++)
+        AddResource(base + i, rt_test, (void *) (intptr_t) i);
+    printf("insert: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_RESOURCES));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_RESOURCES; i++)
+        dixLookupResourceByType(&value, base + (i * 7919) % NUM_BENCH_RESOURCES,
+                                rt_test, NULL, DixReadAccess);
+    printf("lookup: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_RESOURCES));
+
+    /* A drawable and a GC, as in a stream of drawing requests */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_RESOURCES; i++)
+        dixLookupResourceByType(&value, base + 1000 + (i & 1),
+                                rt_test, NULL, DixReadAccess);
+    printf("repeated lookup: %.1f ns\n",
+           elapsed_ns(&start, NUM_BENCH_RESOURCES));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_RESOURCES; i++)
+        dixLookupResourceByType(&value, base + NUM_BENCH_RESOURCES + i,
+                                rt_test, NULL, DixReadAccess);
+    printf("failed lookup: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_RESOURCES));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_RESOURCES; i++)
+        FreeResource(base + i, RT_NONE);
+    printf("delete: %.1f ns\n", elapsed_ns(&start, NUM_BENCH_RESOURCES));
+}
+
+int
+main(int argc, char **argv)
+{
+    resource_init();
+
+    resource_add_lookup_free();
+    resource_same_id();
+    resource_lookup_cache();
+    resource_find_by_type();
+    if (benchmark_requested(argc, argv))
+        resource_benchmark();
+
+    return 0;
+}
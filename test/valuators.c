@@ -0,0 +1,254 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "misc.h"
+#include "inputstr.h"
+#include "inpututils.h"
+#include "eventstr.h"
+#include "exevents.h"
+#include "scrnintstr.h"
+#include "windowstr.h"
+#include "privates.h"
+#include "mipointer.h"
+#include "mipointrst.h"
+
+#include "bench.h"
+
+/**
+ * Tests and benchmarks for the valuator handling in dix/getevents.c,
+ * driven through GetTouchEvents() on a direct touch device with many axes.
+ */
+
+#define NUM_AXES 10
+#define AXIS_MAX 4095
+#define NUM_BENCH_EVENTS 500000
+
+static ScreenRec screen;
+static WindowRec root;
+static DeviceIntRec dev;
+static SpriteInfoRec sprite_info;
+static SpriteRec sprite;
+static miPointerRec pointer;
+static InternalEvent *events;
+
+static void
+set_identity(struct pixman_f_transform *m)
+{
+    memset(m, 0, sizeof(*m));
+    m->m[0][0] = m->m[1][1] = m->m[2][2] = 1.0;
+}
+
+static void
+valuators_init(void)
+{
+    Atom labels[NUM_AXES] = { 0 };
+    int i;
+
+    screenInfo.numScreens = 1;
+    screenInfo.screens[0] = &screen;
+    screenInfo.width = screen.width = 1920;
+    screenInfo.height = screen.height = 1080;
+    screen.root = &root;
+    root.drawable.id = 0x100;
+
+    dixResetPrivates();
+    InitAtoms();
+    assert(dixRegisterPrivateKey(miPointerPrivKey, PRIVATE_DEVICE, 0));
+
+    memset(&dev, 0, sizeof(dev));
+    dev.name = xnfstrdup("touch device");
+    dev.id = 2;
+    dev.type = SLAVE;
+    dev.enabled = TRUE;
+    assert(dixAllocatePrivates(&dev.devPrivates, PRIVATE_DEVICE));
+    pointer.pScreen = &screen;
+    dixSetPrivate(&dev.devPrivates, miPointerPrivKey, &pointer);
+    sprite.hotPhys.pScreen = &screen;
+    sprite_info.sprite = &sprite;
+    dev.spriteInfo = &sprite_info;
+
+    assert(InitValuatorClassDeviceStruct(&dev, NUM_AXES, labels, 0, Absolute));
+    for (i = 0; i < NUM_AXES; i++)
+        assert(InitValuatorAxisStruct(&dev, i, labels[i], 0, AXIS_MAX,
+                                      1000, 0, 1000, Absolute));
+    assert(InitTouchClassDeviceStruct(&dev, 10, XIDirectTouch, 2));
+    set_identity(&dev.scale_and_transform);
+    set_identity(&dev.scale_and_transform_inverse);
+
+    events = InitEventList(GetMaximumEventsNum());
+    assert(events);
+}
+
+/*
+ * The touch emulating the pointer goes through the mi sprite, which isn't
+ * set up here. Begin the DDX touch ahead of GetTouchEvents() so that it
+ * doesn't emulate.
+ */
+static void
+begin_touch(uint32_t ddx_id, const ValuatorMask *mask)
+{
+    DDXTouchPointInfoPtr ti = TouchBeginDDXTouch(&dev, ddx_id);
+
+    assert(ti);
+    ti->emulate_pointer = FALSE;
+    assert(GetTouchEvents(events, &dev, ddx_id, XI_TouchBegin, 0, mask) == 2);
+}
+
+static void
+valuators_touch(void)
+{
+    ValuatorMask *mask = valuator_mask_new(NUM_AXES);
+    RawDeviceEvent *raw = &events[0].raw_event;
+    DeviceEvent *ev = &events[1].device_event;
+    int i;
+
+    /* Clipped to the axis ranges, but not in the raw data */
+    for (i = 0; i < NUM_AXES; i++)
+        valuator_mask_set_double(mask, i, i * 1000.5 - 500);
+    begin_touch(1, mask);
+
+    assert(raw->type == ET_RawTouchBegin);
+    assert(ev->type == ET_TouchBegin);
+    for (i = 0; i < NUM_AXES; i++) {
+        double v = i * 1000.5 - 500;
+        double clipped = v < 0 ? 0 : v > AXIS_MAX ? AXIS_MAX : v;
+
+        assert(BitIsOn(raw->valuators.mask, i));
+        assert(raw->valuators.data_raw[i] == v);
+        assert(raw->valuators.data[i] == clipped);
+        assert(BitIsOn(ev->valuators.mask, i));
+        assert(BitIsOn(ev->valuators.mode, i));
+        assert(ev->valuators.data[i] == clipped);
+        assert(dev.valuator->axisVal[i] == trunc(clipped));
+    }
+
+    /* x/y are scaled to the desktop for the root coordinates */
+    assert(ev->root_x == 0 && ev->root_y == 131);
+
+    /* Missing x/y come from the touch, other axes from the device */
+    valuator_mask_zero(mask);
+    valuator_mask_set_double(mask, 3, 100.25);
+    valuator_mask_set_double(mask, 6, 2048);
+    assert(GetTouchEvents(events, &dev, 1, XI_TouchUpdate, 0, mask) == 2);
+
+    assert(ev->type == ET_TouchUpdate);
+    for (i = 0; i < 7; i++) {
+        Bool set = (i == 0 || i == 1 || i == 3 || i == 6);
+
+        assert(!BitIsOn(ev->valuators.mask, i) == !set);
+        assert(!BitIsOn(raw->valuators.mask, i) == !set);
+    }
+    assert(ev->valuators.data[0] == 0);
+    assert(ev->valuators.data[1] == 500.5);
+    assert(ev->valuators.data[2] == 1501);
+    assert(ev->valuators.data[3] == 100.25);
+    assert(ev->valuators.data[4] == 3502);
+    assert(ev->valuators.data[5] == AXIS_MAX);
+    assert(ev->valuators.data[6] == 2048);
+    assert(dev.valuator->axisVal[3] == 100);
+    assert(ev->root_x == 0 && ev->root_y == 131);
+
+    /* Through the coordinate transformation matrix: swap x and y */
+    memset(&dev.scale_and_transform, 0, sizeof(dev.scale_and_transform));
+    dev.scale_and_transform.m[0][1] = 1;
+    dev.scale_and_transform.m[1][0] = 1;
+    dev.scale_and_transform.m[2][2] = 1;
+    dev.scale_and_transform_inverse = dev.scale_and_transform;
+
+    valuator_mask_zero(mask);
+    valuator_mask_set_double(mask, 0, 1024);
+    valuator_mask_set_double(mask, 1, 2048);
+    assert(GetTouchEvents(events, &dev, 1, XI_TouchUpdate, 0, mask) == 2);
+    assert(raw->valuators.data_raw[0] == 1024);
+    assert(ev->valuators.data[0] == 2048);
+    assert(ev->valuators.data[1] == 1024);
+    assert(ev->root_x == 960 && ev->root_y == 270);
+
+    set_identity(&dev.scale_and_transform);
+    set_identity(&dev.scale_and_transform_inverse);
+
+    assert(GetTouchEvents(events, &dev, 1, XI_TouchEnd, 0, mask) == 2);
+    valuator_mask_free(&mask);
+}
+
+/* Updates of a touch moving around in circles, changing num_axes axes */
+static double
+bench_touch(int num_axes, Bool all_axes)
+{
+    ValuatorMask *mask = valuator_mask_new(NUM_AXES);
+    struct timespec start;
+    double ns;
+    int i, j;
+
+    valuator_mask_set_double(mask, 0, 2048);
+    valuator_mask_set_double(mask, 1, 2048);
+    begin_touch(2, mask);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_EVENTS; i++) {
+        valuator_mask_zero(mask);
+        valuator_mask_set_double(mask, 0, 2048 + 1000 * cos(i * 0.001));
+        valuator_mask_set_double(mask, 1, 2048 + 1000 * sin(i * 0.001));
+        for (j = 2; j < num_axes; j++)
+            if (all_axes || (i + j) % 4 == 0)
+                valuator_mask_set_double(mask, j, (i + j) & AXIS_MAX);
+        GetTouchEvents(events, &dev, 2, XI_TouchUpdate, 0, mask);
+    }
+    ns = elapsed_ns(&start, NUM_BENCH_EVENTS);
+
+    GetTouchEvents(events, &dev, 2, XI_TouchEnd, 0, mask);
+    valuator_mask_free(&mask);
+    return ns;
+}
+
+static void
+valuators_benchmark(void)
+{
+    printf("6 axes: %.1f ns/event, changed only %.1f ns/event\n",
+           bench_touch(6, TRUE), bench_touch(6, FALSE));
+    printf("10 axes: %.1f ns/event, changed only %.1f ns/event\n",
+           bench_touch(10, TRUE), bench_touch(10, FALSE));
+}
+
+int
+main(int argc, char **argv)
+{
+    valuators_init();
+
+    valuators_touch();
+    if (benchmark_requested(argc, argv))
+        valuators_benchmark();
+
+    return 0;
+}
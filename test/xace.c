@@ -0,0 +1,191 @@
+/*
+ * Copyright © 2026 Canonical Ltd
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of the
+ * copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS
+ * SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <stdio.h>
+
+#include "misc.h"
+#include "dix.h"
+#include "dixstruct.h"
+#include "resource.h"
+#include "xace.h"
+#include "xacestr.h"
+
+#include "bench.h"
+
+/**
+ * Tests and benchmarks for the inline hook checks in Xext/xace.h.
+ */
+
+#define NUM_BENCH_REQUESTS 10000000
+
+#ifdef XACE
+
+static int num_calls;
+
+static void
+count_hook(CallbackListPtr *pcbl, void *unused, void *calldata)
+{
+    num_calls++;
+}
+
+static void
+deny_resource(CallbackListPtr *pcbl, void *unused, void *calldata)
+{
+    XaceResourceAccessRec *rec = calldata;
+
+    num_calls++;
+    rec->status = BadAccess;
+}
+
+static void
+xace_unhooked(void)
+{
+    int i;
+
+    for (i = 0; i < XACE_NUM_HOOKS; i++)
+        assert(!XaceHookIsSet(i));
+
+    assert(XaceHook(XACE_RESOURCE_ACCESS, NULL, 1, RT_NONE, NULL,
+                    RT_NONE, NULL, DixReadAccess) == Success);
+    assert(XaceHookDispatch(NULL, 1) == Success);
+    assert(XaceHookDispatch(NULL, 200) == Success);
+    XaceHookAuditEnd(NULL, Success);
+}
+
+static void
+xace_register_delete(void)
+{
+    num_calls = 0;
+    assert(XaceRegisterCallback(XACE_RESOURCE_ACCESS, deny_resource, NULL));
+    assert(XaceHookIsSet(XACE_RESOURCE_ACCESS));
+    assert(!XaceHookIsSet(XACE_DEVICE_ACCESS));
+    assert(XaceHook(XACE_RESOURCE_ACCESS, NULL, 1, RT_NONE, NULL,
+                    RT_NONE, NULL, DixReadAccess) == BadAccess);
+    assert(num_calls == 1);
+
+    assert(XaceRegisterCallback(XACE_RESOURCE_ACCESS, count_hook, NULL));
+    assert(XaceDeleteCallback(XACE_RESOURCE_ACCESS, deny_resource, NULL));
+    assert(XaceHook(XACE_RESOURCE_ACCESS, NULL, 1, RT_NONE, NULL,
+                    RT_NONE, NULL, DixReadAccess) == Success);
+    assert(num_calls == 2);
+
+    /* An emptied list still goes through the function, which finds
+     * nothing to call */
+    assert(XaceDeleteCallback(XACE_RESOURCE_ACCESS, count_hook, NULL));
+    assert(XaceHook(XACE_RESOURCE_ACCESS, NULL, 1, RT_NONE, NULL,
+                    RT_NONE, NULL, DixReadAccess) == Success);
+    assert(num_calls == 2);
+
+    /* Any of the dispatch hooks turns on the dispatch path */
+    assert(XaceRegisterCallback(XACE_AUDIT_BEGIN, count_hook, NULL));
+    assert(XaceHookDispatch(NULL, 1) == Success);
+    assert(num_calls == 3);
+    XaceHookAuditEnd(NULL, Success);
+    assert(num_calls == 3);
+    assert(XaceDeleteCallback(XACE_AUDIT_BEGIN, count_hook, NULL));
+}
+
+/* Security modules built against older headers add their callbacks to
+ * XaceHooks directly, and must not be skipped */
+static void
+xace_add_callback(void)
+{
+    num_calls = 0;
+    assert(AddCallback(XaceHooks + XACE_PROPERTY_ACCESS, count_hook, NULL));
+    assert(XaceHookIsSet(XACE_PROPERTY_ACCESS));
+    assert(XaceHookPropertyAccess(NULL, NULL, NULL, DixReadAccess) ==
+           Success);
+    assert(num_calls == 1);
+
+    assert(AddCallback(XaceHooks + XACE_CORE_DISPATCH, count_hook, NULL));
+    assert(XaceHookDispatch(NULL, 1) == Success);
+    assert(num_calls == 2);
+
+    DeleteCallback(XaceHooks + XACE_PROPERTY_ACCESS, count_hook, NULL);
+    DeleteCallback(XaceHooks + XACE_CORE_DISPATCH, count_hook, NULL);
+}
+
+/* What Dispatch and a request touching two resources go through */
+#define REQUEST_HOOKS(dispatch, hook, auditend) do {                    \
+        int rc = dispatch(NULL, 1);                                     \
+        rc |= hook(XACE_RESOURCE_ACCESS, NULL, i, RT_NONE, NULL,        \
+                   RT_NONE, NULL, DixReadAccess);                       \
+        rc |= hook(XACE_RESOURCE_ACCESS, NULL, i + 1, RT_NONE, NULL,    \
+                   RT_NONE, NULL, DixWriteAccess);                      \
+        auditend(NULL, rc);                                             \
+    } while (0)
+
+static void
+xace_benchmark(void)
+{
+    struct timespec start;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_REQUESTS; i++)
+        REQUEST_HOOKS((XaceHookDispatch), (XaceHook), (XaceHookAuditEnd));
+    printf("unhooked, function calls: %.2f ns/request\n",
+           elapsed_ns(&start, NUM_BENCH_REQUESTS));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_REQUESTS; i++)
+        REQUEST_HOOKS(XaceHookDispatch, XaceHook, XaceHookAuditEnd);
+    printf("unhooked, inline checks: %.2f ns/request\n",
+           elapsed_ns(&start, NUM_BENCH_REQUESTS));
+
+    XaceRegisterCallback(XACE_RESOURCE_ACCESS, count_hook, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NUM_BENCH_REQUESTS; i++)
+        REQUEST_HOOKS(XaceHookDispatch, XaceHook, XaceHookAuditEnd);
+    printf("resource hook set: %.2f ns/request\n",
+           elapsed_ns(&start, NUM_BENCH_REQUESTS));
+    XaceDeleteCallback(XACE_RESOURCE_ACCESS, count_hook, NULL);
+}
+
+int
+main(int argc, char **argv)
+{
+    xace_unhooked();
+    xace_register_delete();
+    xace_add_callback();
+    if (benchmark_requested(argc, argv))
+        xace_benchmark();
+
+    return 0;
+}
+
+#else
+
+int
+main(int argc, char **argv)
+{
+    return 0;
+}
+
+#endif                          /* XACE */
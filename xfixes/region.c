@@ -765,10 +765,11 @@ ProcXFixesExpandRegion(ClientPtr client)
     RegionPtr pSource, pDestination;
 
     REQUEST(xXFixesExpandRegionReq);
-    BoxPtr pTmp;
+    RegionBuilderRec builder;
     BoxPtr pSrc;
     int nBoxes;
     int i;
+    Bool ok;
 
     REQUEST_SIZE_MATCH(xXFixesExpandRegionReq);
     VERIFY_REGION(pSource, stuff->source, client, DixReadAccess);
@@ -777,23 +778,21 @@ ProcXFixesExpandRegion(ClientPtr client)
     nBoxes = RegionNumRects(pSource);
     pSrc = RegionRects(pSource);
     if (nBoxes) {
-        pTmp = xallocarray(nBoxes, sizeof(BoxRec));
-        if (!pTmp)
-            return BadAlloc;
-        for (i = 0; i < nBoxes; i++) {
-            pTmp[i].x1 = pSrc[i].x1 - stuff->left;
-            pTmp[i].x2 = pSrc[i].x2 + stuff->right;
-            pTmp[i].y1 = pSrc[i].y1 - stuff->top;
-            pTmp[i].y2 = pSrc[i].y2 + stuff->bottom;
-        }
-        RegionEmpty(pDestination);
+        /* Expanded boxes overlap freely, so band them all at once */
+        RegionBuilderInit(&builder);
         for (i = 0; i < nBoxes; i++) {
-            RegionRec r;
+            BoxRec box;
 
-            RegionInit(&r, &pTmp[i], 0);
-            RegionUnion(pDestination, pDestination, &r);
+            box.x1 = pSrc[i].x1 - stuff->left;
+            box.x2 = pSrc[i].x2 + stuff->right;
+            box.y1 = pSrc[i].y1 - stuff->top;
+            box.y2 = pSrc[i].y2 + stuff->bottom;
+            RegionBuilderAddBox(&builder, &box);
         }
-        free(pTmp);
+        ok = RegionBuilderFinish(&builder, pDestination);
+        RegionBuilderUninit(&builder);
+        if (!ok)
+            return BadAlloc;
     }
     return Success;
 }